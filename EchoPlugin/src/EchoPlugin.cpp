@@ -12,8 +12,7 @@
 #include <Http/Server.hpp>
 #include <inttypes.h>
 #include <Json/Value.hpp>
-#include <sstream>
-#include <StringExtensions/StringExtensions.hpp>
+#include <string>
 #include <WebServer/PluginEntryPoint.hpp>
 
 #ifdef _WIN32
@@ -22,6 +21,107 @@
 #define API
 #endif /* _WIN32 / POSIX */
 
+namespace {
+
+    /**
+     * This is the markup which comes before the rows of the table
+     * of request headers in the generated page.
+     */
+    const char PAGE_HEAD[] = (
+        "<!DOCTYPE html>"
+        "<html>"
+        "<head>"
+        "<meta charset=\"UTF-8\">"
+        "<title>Excalibur - Request Echo</title>"
+        "</head>"
+        ""
+        "<body>"
+        "<table><thead><tr><th>Header</th><th>Value</th></tr></thead>"
+        "<tbody>"
+    );
+
+    /**
+     * This is the markup which comes after the rows of the table
+     * of request headers in the generated page.
+     */
+    const char PAGE_TAIL[] = (
+        "</tbody></table>"
+        "</body>"
+        ""
+        "</html>"
+    );
+
+    /**
+     * This is the markup which comes before the name
+     * of a header in its row of the table.
+     */
+    const char ROW_HEAD[] = "<tr><td>";
+
+    /**
+     * This is the markup which comes between the name and value
+     * of a header in its row of the table.
+     */
+    const char ROW_MIDDLE[] = "</td><td>";
+
+    /**
+     * This is the markup which comes after the value
+     * of a header in its row of the table.
+     */
+    const char ROW_TAIL[] = "</td></tr>";
+
+    /**
+     * This function returns the length of the string literal given as its
+     * only argument, not counting its null terminator.  Only the type of
+     * the argument is used, so the length is known at compile time.
+     *
+     * @return
+     *     The length of the given string literal is returned.
+     */
+    template< size_t N > constexpr size_t LiteralLength(const char (&)[N]) {
+        return N - 1;
+    }
+
+    /**
+     * This function renders the page which reports the given
+     * request headers.  The page is built in a single buffer,
+     * reserved up front to hold the whole page, so that it's
+     * allocated only once.
+     *
+     * @param[in] headers
+     *     These are the request headers to report.
+     *
+     * @return
+     *     The generated page is returned.
+     */
+    std::string RenderPage(const MessageHeaders::MessageHeaders::Headers& headers) {
+        size_t length = (
+            LiteralLength(PAGE_HEAD)
+            + LiteralLength(PAGE_TAIL)
+            + headers.size() * (
+                LiteralLength(ROW_HEAD)
+                + LiteralLength(ROW_MIDDLE)
+                + LiteralLength(ROW_TAIL)
+            )
+        );
+        for (const auto& header: headers) {
+            length += header.name.length() + header.value.length();
+        }
+        std::string page;
+        page.reserve(length);
+        (void)page.append(PAGE_HEAD, LiteralLength(PAGE_HEAD));
+        for (const auto& header: headers) {
+            (void)page.append(ROW_HEAD, LiteralLength(ROW_HEAD));
+            (void)page.append(header.name);
+            (void)page.append(ROW_MIDDLE, LiteralLength(ROW_MIDDLE));
+            (void)page.append(header.value);
+            (void)page.append(ROW_TAIL, LiteralLength(ROW_TAIL));
+        }
+        (void)page.append(PAGE_TAIL, LiteralLength(PAGE_TAIL));
+        return page;
+    }
+
+}
+
 /**
  * This is the type expected for the entry point functions
  * for all server plug-ins.
@@ -83,32 +183,8 @@ extern "C" API void LoadPlugin(
             response.statusCode = 200;
             response.reasonPhrase = "OK";
             response.headers.AddHeader("Content-Type", "text/html");
-            std::ostringstream reportRows;
-            for (const auto& header: request.headers.GetAll()) {
-                reportRows
-                    << "<tr>"
-                    << "<td>" << header.name << "</td>"
-                    << "<td>" << header.value << "</td>"
-                    << "</tr>";
-            }
-            response.body = (
-                "<!DOCTYPE html>"
-                "<html>"
-                "<head>"
-                "<meta charset=\"UTF-8\">"
-                "<title>Excalibur - Request Echo</title>"
-                "</head>"
-                ""
-                "<body>"
-                "<table><thead><tr><th>Header</th><th>Value</th></tr></thead>"
-                "<tbody>"
-                + reportRows.str()
-                + "</tbody></table>"
-                "</body>"
-                ""
-                "</html>"
-            );
-            response.headers.AddHeader("Content-Length", StringExtensions::sprintf("%zu", response.body.length()));
+            response.body = RenderPage(request.headers.GetAll());
+            response.headers.AddHeader("Content-Length", std::to_string(response.body.length()));
             return response;
         }
     );
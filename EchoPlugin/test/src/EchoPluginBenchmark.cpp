@@ -0,0 +1,137 @@
+/**
+ * @file EchoPluginBenchmark.cpp
+ *
+ * This module contains a benchmark of the request handler of the
+ * Echo web-server plugin.  It drives the handler directly, through
+ * a mock server, with requests carrying different numbers of headers,
+ * and reports throughput, latency and memory allocation for each.
+ *
+ * Usage: EchoPluginBenchmark [REQUESTS]
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <functional>
+#include <PluginBenchmark/PluginBenchmark.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <StringExtensions/StringExtensions.hpp>
+#include <vector>
+#include <WebServer/PluginEntryPoint.hpp>
+
+#ifdef _WIN32
+#define API __declspec(dllimport)
+#else /* POSIX */
+#define API
+#endif /* _WIN32 / POSIX */
+extern "C" API void LoadPlugin(
+    Http::IServer* server,
+    Json::Value configuration,
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate,
+    std::function< void() >& unloadDelegate
+);
+
+namespace {
+
+    /**
+     * This is the number of requests made in each scenario,
+     * unless given on the command line.
+     */
+    constexpr size_t DEFAULT_REQUESTS = 200000;
+
+    /**
+     * This is the number of headers in the request of the
+     * "many" scenario.
+     */
+    constexpr size_t MANY_HEADERS = 64;
+
+    /**
+     * This function builds a request for the echo resource
+     * with the given headers.
+     *
+     * @param[in] headers
+     *     These are the headers to add to the request.
+     *
+     * @return
+     *     The request is returned.
+     */
+    Http::Request MakeRequest(
+        const std::vector< std::pair< std::string, std::string > >& headers
+    ) {
+        Http::Request request;
+        request.method = "GET";
+        (void)request.target.ParseFromString("/echo");
+        for (const auto& header: headers) {
+            request.headers.AddHeader(header.first, header.second);
+        }
+        return request;
+    }
+
+}
+
+/**
+ * This function is the entrypoint of the program.
+ *
+ * @param[in] argc
+ *     This is the number of command-line arguments given to the program.
+ *
+ * @param[in] argv
+ *     This is the array of command-line arguments given to the program.
+ */
+int main(int argc, char* argv[]) {
+    size_t numRequests = DEFAULT_REQUESTS;
+    if (!PluginBenchmark::ParseRequestCount(argc, argv, numRequests)) {
+        return EXIT_FAILURE;
+    }
+
+    // Load the plug-in.
+    PluginBenchmark::MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/echo");
+    LoadPlugin(
+        &server,
+        config,
+        PluginBenchmark::PrintWarnings,
+        unloadDelegate
+    );
+    if (server.registeredResourceDelegate == nullptr) {
+        fprintf(stderr, "plug-in failed to load\n");
+        return EXIT_FAILURE;
+    }
+
+    // Set up the scenarios: a request with no headers, one with the
+    // headers a typical browser or load balancer health check sends,
+    // and one with a great many headers.
+    const std::vector< std::pair< std::string, std::string > > typicalHeaders{
+        {"Host", "www.example.com"},
+        {"User-Agent", "Mozilla/5.0 (X11; Linux x86_64; rv:60.0) Gecko/20100101 Firefox/60.0"},
+        {"Accept", "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8"},
+        {"Accept-Language", "en-US,en;q=0.5"},
+        {"Accept-Encoding", "gzip, deflate, br"},
+        {"X-Forwarded-For", "203.0.113.195, 70.41.3.18, 150.172.238.178"},
+        {"Connection", "keep-alive"},
+        {"Cache-Control", "max-age=0"},
+    };
+    std::vector< std::pair< std::string, std::string > > manyHeaders;
+    for (size_t i = 0; i < MANY_HEADERS; ++i) {
+        manyHeaders.emplace_back(
+            StringExtensions::sprintf("X-Header-%zu", i),
+            std::string(16 + i, 'x')
+        );
+    }
+
+    // Run the scenarios and report the results.
+    PluginBenchmark::RunScenarios(
+        {
+            {"empty", {MakeRequest({})}},
+            {"typical", {MakeRequest(typicalHeaders)}},
+            {"many", {MakeRequest(manyHeaders)}},
+        },
+        server.registeredResourceDelegate,
+        numRequests
+    );
+    unloadDelegate();
+    return EXIT_SUCCESS;
+}
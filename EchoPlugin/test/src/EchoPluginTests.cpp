@@ -249,3 +249,27 @@ TEST_F(EchoPluginTests, ProperHeadersTableHeaderRow) {
     static std::regex pattern("<table><thead><tr><th>Header</th><th>Value</th></tr></thead>");
     EXPECT_TRUE(std::regex_search(response.body, pattern));
 }
+
+TEST_F(EchoPluginTests, ContentLengthMatchesBody) {
+    for (size_t numHeaders = 0; numHeaders < 4; ++numHeaders) {
+        Http::Request request;
+        (void)request.target.ParseFromString("/echo");
+        std::string expectedRows;
+        for (size_t i = 0; i < numHeaders; ++i) {
+            const auto name = StringExtensions::sprintf("X-Header-%zu", i);
+            const auto value = std::string(i * 100, 'x');
+            request.headers.SetHeader(name, value);
+            expectedRows += "<tr><td>" + name + "</td><td>" + value + "</td></tr>";
+        }
+        const auto response = server.registeredResourceDelegate(request, nullptr, "");
+        EXPECT_EQ(
+            StringExtensions::sprintf("%zu", response.body.length()),
+            response.headers.GetHeaderValue("Content-Length")
+        ) << numHeaders;
+        EXPECT_NE(
+            std::string::npos,
+            response.body.find("<tbody>" + expectedRows + "</tbody>")
+        ) << numHeaders;
+        EXPECT_EQ("</html>", response.body.substr(response.body.length() - 7)) << numHeaders;
+    }
+}
@@ -0,0 +1,184 @@
+#ifndef PLUGIN_BENCHMARK_PLUGIN_BENCHMARK_HPP
+#define PLUGIN_BENCHMARK_PLUGIN_BENCHMARK_HPP
+
+/**
+ * @file PluginBenchmark.hpp
+ *
+ * This module declares the harness shared by the benchmarks of the
+ * request handlers of the web-server plugins.  It provides a mock
+ * server through which to load a plug-in, and runs mixes of requests
+ * through the handler the plug-in registers, reporting throughput,
+ * latency, memory allocation and system calls for each mix.
+ *
+ * Linking this module into a program replaces the global allocator
+ * of the program, in order to count allocations.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <Http/IServer.hpp>
+#include <memory>
+#include <set>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace PluginBenchmark {
+
+    /**
+     * This is a fake time-keeper which is used to run the plug-in.
+     */
+    struct MockTimeKeeper
+        : public Http::TimeKeeper
+    {
+        // Properties
+
+        double currentTime = 0.0;
+
+        // Methods
+
+        // Http::TimeKeeper
+
+        virtual double GetCurrentTime() override;
+    };
+
+    /**
+     * This is a fake server which is used to run the plug-in.
+     */
+    struct MockServer
+        : public Http::IServer
+    {
+        // Properties
+
+        /**
+         * This is the delegate that the unit under test has registered
+         * to be called to handle resource requests.
+         */
+        ResourceDelegate registeredResourceDelegate;
+
+        /**
+         * This is the time keeper given to the plug-in.
+         */
+        std::shared_ptr< MockTimeKeeper > timeKeeper = std::make_shared< MockTimeKeeper >();
+
+        // Methods
+
+        // IServer
+    public:
+        virtual SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate SubscribeToDiagnostics(
+            SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+            size_t minLevel = 0
+        ) override;
+        virtual std::string GetConfigurationItem(const std::string& key) override;
+        virtual void SetConfigurationItem(
+            const std::string& key,
+            const std::string& value
+        ) override;
+        virtual UnregistrationDelegate RegisterResource(
+            const std::vector< std::string >& resourceSubspacePath,
+            ResourceDelegate resourceDelegate
+        ) override;
+        virtual UnregistrationDelegate RegisterBanDelegate(
+            BanDelegate banDelegate
+        ) override;
+        virtual std::shared_ptr< Http::TimeKeeper > GetTimeKeeper() override;
+        virtual void Ban(
+            const std::string& peerAddress,
+            const std::string& reason
+        ) override;
+        virtual void Unban(const std::string& peerAddress) override;
+        virtual std::set< std::string > GetBans() override;
+        virtual void AcceptlistAdd(const std::string& peerAddress) override;
+        virtual void AcceptlistRemove(const std::string& peerAddress) override;
+        virtual std::set< std::string > GetAcceptlist() override;
+    };
+
+    /**
+     * This describes one mix of requests to make of the handler.
+     */
+    struct Scenario {
+        /**
+         * This is the name used to report the results of the scenario.
+         */
+        std::string name;
+
+        /**
+         * These are the requests to make, chosen at random
+         * with equal probability.
+         */
+        std::vector< Http::Request > requests;
+    };
+
+    /**
+     * This function parses the number of requests to make in each
+     * scenario from the command line of the program, if given.
+     *
+     * @param[in] argc
+     *     This is the number of command-line arguments given to the program.
+     *
+     * @param[in] argv
+     *     This is the array of command-line arguments given to the program.
+     *
+     * @param[in,out] numRequests
+     *     On input, this is the number of requests to make if none
+     *     is given on the command line.  On output, this is the number
+     *     of requests to make.
+     *
+     * @return
+     *     An indication of whether or not the command line was valid
+     *     is returned.  If it wasn't, the usage of the program has
+     *     been printed to the standard error stream.
+     */
+    bool ParseRequestCount(
+        int argc,
+        char* argv[],
+        size_t& numRequests
+    );
+
+    /**
+     * This function prints the given diagnostic message to the standard
+     * error stream if it's a warning or worse.  It's meant to be given
+     * to the plug-in as its diagnostic message delegate.
+     *
+     * @param[in] senderName
+     *     This identifies the origin of the diagnostic information.
+     *
+     * @param[in] level
+     *     This is used to filter out less-important information.
+     *     The level is higher the more important the information is.
+     *
+     * @param[in] message
+     *     This is the content of the message.
+     */
+    void PrintWarnings(
+        std::string senderName,
+        size_t level,
+        std::string message
+    );
+
+    /**
+     * This function runs each of the given scenarios, along with one
+     * more, named "mix", which combines the requests of all of them,
+     * making the given number of requests of the given handler in each,
+     * and prints a table of the measurements taken to the standard
+     * output stream.
+     *
+     * @param[in] scenarios
+     *     These are the scenarios to run.
+     *
+     * @param[in] resourceDelegate
+     *     This is the handler to benchmark.
+     *
+     * @param[in] numRequests
+     *     This is the number of requests to make in each scenario.
+     */
+    void RunScenarios(
+        std::vector< Scenario > scenarios,
+        const Http::IServer::ResourceDelegate& resourceDelegate,
+        size_t numRequests
+    );
+
+}
+
+#endif /* PLUGIN_BENCHMARK_PLUGIN_BENCHMARK_HPP */
@@ -0,0 +1,380 @@
+/**
+ * @file PluginBenchmark.cpp
+ *
+ * This module contains the implementation of the harness shared by the
+ * benchmarks of the request handlers of the web-server plugins.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <PluginBenchmark/PluginBenchmark.hpp>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <StringExtensions/StringExtensions.hpp>
+
+namespace {
+
+    /**
+     * This counts the number of times memory was allocated
+     * through the global allocator.
+     */
+    std::atomic< uint64_t > allocations(0);
+
+    /**
+     * This counts the number of bytes allocated
+     * through the global allocator.
+     */
+    std::atomic< uint64_t > bytesAllocated(0);
+
+    /**
+     * This holds the measurements taken while running one scenario.
+     */
+    struct Results {
+        /**
+         * This is the number of requests made.
+         */
+        size_t requests = 0;
+
+        /**
+         * This is the total time taken to make the requests, in seconds.
+         */
+        double seconds = 0.0;
+
+        /**
+         * These are the times taken to handle each request,
+         * in nanoseconds.
+         */
+        std::vector< uint64_t > latencies;
+
+        /**
+         * This is the number of times memory was allocated.
+         */
+        uint64_t allocations = 0;
+
+        /**
+         * This is the number of bytes of memory allocated.
+         */
+        uint64_t bytesAllocated = 0;
+
+        /**
+         * This is the number of read and write system calls made,
+         * or -1 if they couldn't be counted.
+         */
+        int64_t syscalls = -1;
+    };
+
+    /**
+     * This function returns the number of read and write system calls
+     * made by the process so far, as reported by Linux.
+     *
+     * @return
+     *     The number of read and write system calls made by the process
+     *     is returned, or -1 if they can't be counted on this platform.
+     */
+    int64_t CountSystemCalls() {
+        FILE* io = fopen("/proc/self/io", "r");
+        if (io == NULL) {
+            return -1;
+        }
+        int64_t total = 0;
+        char line[128];
+        while (fgets(line, sizeof(line), io) != NULL) {
+            unsigned long long count;
+            if (
+                (sscanf(line, "syscr: %llu", &count) == 1)
+                || (sscanf(line, "syscw: %llu", &count) == 1)
+            ) {
+                total += (int64_t)count;
+            }
+        }
+        (void)fclose(io);
+        return total;
+    }
+
+    /**
+     * This function makes the requests of the given scenario
+     * of the given handler, measuring how it performs.
+     *
+     * @param[in] scenario
+     *     This is the scenario to run.
+     *
+     * @param[in] resourceDelegate
+     *     This is the handler to benchmark.
+     *
+     * @param[in] numRequests
+     *     This is the number of requests to make.
+     *
+     * @return
+     *     The measurements taken are returned.
+     */
+    Results RunScenario(
+        const PluginBenchmark::Scenario& scenario,
+        const Http::IServer::ResourceDelegate& resourceDelegate,
+        size_t numRequests
+    ) {
+        // Choose the requests ahead of time, so that choosing them
+        // isn't measured, and make each of them once, to warm up
+        // the handler.
+        std::mt19937 generator;
+        std::uniform_int_distribution< size_t > distribution(0, scenario.requests.size() - 1);
+        std::vector< size_t > order(numRequests);
+        for (auto& index: order) {
+            index = distribution(generator);
+        }
+        for (const auto& request: scenario.requests) {
+            (void)resourceDelegate(request, nullptr, "");
+        }
+
+        // Make the requests, timing each one.
+        Results results;
+        results.requests = numRequests;
+        results.latencies.reserve(numRequests);
+        const auto syscallsBefore = CountSystemCalls();
+        const auto allocationsBefore = allocations.load();
+        const auto bytesAllocatedBefore = bytesAllocated.load();
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto index: order) {
+            const auto requestStart = std::chrono::steady_clock::now();
+            (void)resourceDelegate(scenario.requests[index], nullptr, "");
+            const auto requestEnd = std::chrono::steady_clock::now();
+            results.latencies.push_back(
+                (uint64_t)std::chrono::duration_cast< std::chrono::nanoseconds >(
+                    requestEnd - requestStart
+                ).count()
+            );
+        }
+        const auto end = std::chrono::steady_clock::now();
+        results.bytesAllocated = bytesAllocated.load() - bytesAllocatedBefore;
+        results.allocations = allocations.load() - allocationsBefore;
+        const auto syscallsAfter = CountSystemCalls();
+        if (
+            (syscallsBefore >= 0)
+            && (syscallsAfter >= 0)
+        ) {
+            results.syscalls = syscallsAfter - syscallsBefore;
+        }
+        results.seconds = std::chrono::duration< double >(end - start).count();
+        std::sort(results.latencies.begin(), results.latencies.end());
+        return results;
+    }
+
+    /**
+     * This function reports the given measurements.
+     *
+     * @param[in] name
+     *     This is the name of the scenario measured.
+     *
+     * @param[in] results
+     *     These are the measurements to report.
+     */
+    void ReportResults(
+        const std::string& name,
+        const Results& results
+    ) {
+        const auto percentile = [&results](double fraction){
+            const auto index = std::min(
+                (size_t)(fraction * results.latencies.size()),
+                results.latencies.size() - 1
+            );
+            return (double)results.latencies[index] / 1000.0;
+        };
+        const auto perRequest = [&results](uint64_t total){
+            return (double)total / (double)results.requests;
+        };
+        printf(
+            "%-14s %12.0f %10.2f %10.2f %10.1f %12.1f %10s\n",
+            name.c_str(),
+            (double)results.requests / results.seconds,
+            percentile(0.50),
+            percentile(0.99),
+            perRequest(results.allocations),
+            perRequest(results.bytesAllocated),
+            (
+                (results.syscalls < 0)
+                ? "n/a"
+                : StringExtensions::sprintf("%.2f", perRequest((uint64_t)results.syscalls)).c_str()
+            )
+        );
+    }
+
+}
+
+namespace PluginBenchmark {
+
+    double MockTimeKeeper::GetCurrentTime() {
+        return currentTime;
+    }
+
+    SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate MockServer::SubscribeToDiagnostics(
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+        size_t minLevel
+    ) {
+        return []{};
+    }
+
+    std::string MockServer::GetConfigurationItem(const std::string& key) {
+        return "";
+    }
+
+    void MockServer::SetConfigurationItem(
+        const std::string& key,
+        const std::string& value
+    ) {
+    }
+
+    Http::IServer::UnregistrationDelegate MockServer::RegisterResource(
+        const std::vector< std::string >& resourceSubspacePath,
+        ResourceDelegate resourceDelegate
+    ) {
+        registeredResourceDelegate = resourceDelegate;
+        return []{};
+    }
+
+    Http::IServer::UnregistrationDelegate MockServer::RegisterBanDelegate(
+        BanDelegate banDelegate
+    ) {
+        return []{};
+    }
+
+    std::shared_ptr< Http::TimeKeeper > MockServer::GetTimeKeeper() {
+        return timeKeeper;
+    }
+
+    void MockServer::Ban(
+        const std::string& peerAddress,
+        const std::string& reason
+    ) {
+    }
+
+    void MockServer::Unban(const std::string& peerAddress) {
+    }
+
+    std::set< std::string > MockServer::GetBans() {
+        return {};
+    }
+
+    void MockServer::AcceptlistAdd(const std::string& peerAddress) {
+    }
+
+    void MockServer::AcceptlistRemove(const std::string& peerAddress) {
+    }
+
+    std::set< std::string > MockServer::GetAcceptlist() {
+        return {};
+    }
+
+    bool ParseRequestCount(
+        int argc,
+        char* argv[],
+        size_t& numRequests
+    ) {
+        if (argc > 1) {
+            numRequests = (size_t)strtoull(argv[1], NULL, 10);
+            if (numRequests == 0) {
+                fprintf(stderr, "usage: %s [REQUESTS]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void PrintWarnings(
+        std::string senderName,
+        size_t level,
+        std::string message
+    ) {
+        if (level >= SystemAbstractions::DiagnosticsSender::Levels::WARNING) {
+            fprintf(
+                stderr,
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        }
+    }
+
+    void RunScenarios(
+        std::vector< Scenario > scenarios,
+        const Http::IServer::ResourceDelegate& resourceDelegate,
+        size_t numRequests
+    ) {
+        Scenario mix;
+        mix.name = "mix";
+        for (const auto& scenario: scenarios) {
+            mix.requests.insert(
+                mix.requests.end(),
+                scenario.requests.begin(),
+                scenario.requests.end()
+            );
+        }
+        scenarios.push_back(mix);
+        printf(
+            "%-14s %12s %10s %10s %10s %12s %10s\n",
+            "scenario",
+            "requests/s",
+            "p50 (us)",
+            "p99 (us)",
+            "allocs/req",
+            "bytes/req",
+            "I/O sc/req"
+        );
+        for (const auto& scenario: scenarios) {
+            ReportResults(
+                scenario.name,
+                RunScenario(scenario, resourceDelegate, numRequests)
+            );
+        }
+    }
+
+}
+
+/**
+ * This function replaces the global allocator, in order to
+ * count allocations.
+ *
+ * @param[in] size
+ *     This is the number of bytes to allocate.
+ *
+ * @return
+ *     The allocated memory is returned.
+ */
+void* operator new(size_t size) {
+    ++allocations;
+    bytesAllocated += size;
+    const auto memory = malloc(size == 0 ? 1 : size);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+/**
+ * This function replaces the global deallocator, to go along
+ * with the replaced global allocator.
+ *
+ * @param[in] memory
+ *     This is the memory to free.
+ */
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+/**
+ * This function replaces the sized global deallocator, to go along
+ * with the replaced global allocator.
+ *
+ * @param[in] memory
+ *     This is the memory to free.
+ *
+ * @param[in] size
+ *     This is the number of bytes which were allocated.
+ */
+void operator delete(void* memory, size_t size) noexcept {
+    free(memory);
+}
@@ -0,0 +1,341 @@
+/**
+ * @file AssetArchive.cpp
+ *
+ * This module contains the implementation of the AssetArchive class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "AssetArchive.hpp"
+#include "FileInfo.hpp"
+
+#include <algorithm>
+#include <string.h>
+#include <StringExtensions/StringExtensions.hpp>
+
+namespace {
+
+    /**
+     * This function decodes the little-endian 32-bit unsigned integer
+     * at the given location.
+     *
+     * @param[in] data
+     *     This points to the integer to decode.
+     *
+     * @return
+     *     The decoded integer is returned.
+     */
+    uint32_t DecodeUint32(const char* data) {
+        const auto bytes = (const uint8_t*)data;
+        return (
+            (uint32_t)bytes[0]
+            | ((uint32_t)bytes[1] << 8)
+            | ((uint32_t)bytes[2] << 16)
+            | ((uint32_t)bytes[3] << 24)
+        );
+    }
+
+    /**
+     * This function decodes the little-endian 64-bit unsigned integer
+     * at the given location.
+     *
+     * @param[in] data
+     *     This points to the integer to decode.
+     *
+     * @return
+     *     The decoded integer is returned.
+     */
+    uint64_t DecodeUint64(const char* data) {
+        return (
+            (uint64_t)DecodeUint32(data)
+            | ((uint64_t)DecodeUint32(data + 4) << 32)
+        );
+    }
+
+    /**
+     * This function determines whether or not the given range
+     * lies entirely within a region of the given size.
+     *
+     * @param[in] offset
+     *     This is the offset of the first byte of the range.
+     *
+     * @param[in] size
+     *     This is the number of bytes in the range.
+     *
+     * @param[in] limit
+     *     This is the size of the region.
+     *
+     * @return
+     *     An indication of whether or not the range lies entirely
+     *     within the region is returned.
+     */
+    bool IsWithin(
+        uint64_t offset,
+        uint64_t size,
+        uint64_t limit
+    ) {
+        return (
+            (offset <= limit)
+            && (size <= limit - offset)
+        );
+    }
+
+}
+
+constexpr char AssetArchive::MAGIC[8];
+constexpr uint32_t AssetArchive::VERSION;
+constexpr size_t AssetArchive::HEADER_SIZE;
+constexpr size_t AssetArchive::RECORD_SIZE;
+constexpr uint32_t AssetArchive::FLAG_COMPRESSIBLE;
+
+/**
+ * This contains the private properties of the AssetArchive class.
+ */
+struct AssetArchive::Impl {
+    // Properties
+
+    /**
+     * This is the path of the archive.
+     */
+    std::string path;
+
+    /**
+     * This is the memory mapping of the archive.
+     */
+    std::shared_ptr< const FileMapping > mapping;
+
+    /**
+     * This is the number of assets in the archive.
+     */
+    size_t assetCount = 0;
+
+    /**
+     * This points to the first record of the index of the archive.
+     */
+    const char* index = nullptr;
+
+    /**
+     * This points to the string table of the archive.
+     */
+    const char* strings = nullptr;
+
+    // Methods
+
+    /**
+     * This method decodes the index record at the given position.
+     *
+     * @param[in] i
+     *     This is the position of the record in the index.
+     *
+     * @param[out] asset
+     *     This is where to store the description of the asset.
+     *
+     * @param[out] path
+     *     This is where to store a pointer to the path of the asset.
+     *
+     * @param[out] pathLength
+     *     This is where to store the length of the path of the asset.
+     */
+    void DecodeRecord(
+        size_t i,
+        Asset& asset,
+        const char*& path,
+        size_t& pathLength
+    ) const {
+        const auto record = index + i * RECORD_SIZE;
+        path = strings + DecodeUint32(record);
+        pathLength = DecodeUint32(record + 4);
+        asset.contentType = strings + DecodeUint32(record + 8);
+        asset.contentTypeLength = DecodeUint32(record + 12);
+        asset.entityTag = strings + DecodeUint32(record + 16);
+        asset.entityTagLength = DecodeUint32(record + 20);
+        asset.compressible = ((DecodeUint32(record + 24) & FLAG_COMPRESSIBLE) != 0);
+        asset.lastModifiedTime = (int64_t)DecodeUint64(record + 32);
+        asset.identity.offset = DecodeUint64(record + 40);
+        asset.identity.size = DecodeUint64(record + 48);
+        asset.brotli.offset = DecodeUint64(record + 56);
+        asset.brotli.size = DecodeUint64(record + 64);
+        asset.gzip.offset = DecodeUint64(record + 72);
+        asset.gzip.size = DecodeUint64(record + 80);
+    }
+
+    /**
+     * This method checks that every record in the index refers only
+     * to strings and contents within the archive, and that the records
+     * are sorted by path, so that lookups need no further checks.
+     *
+     * @param[in] stringsSize
+     *     This is the size of the string table of the archive.
+     *
+     * @return
+     *     An indication of whether or not the index is well-formed
+     *     is returned.
+     */
+    bool CheckIndex(uint64_t stringsSize) const {
+        const auto size = mapping->GetSize();
+        const char* previousPath = nullptr;
+        size_t previousPathLength = 0;
+        for (size_t i = 0; i < assetCount; ++i) {
+            const auto record = index + i * RECORD_SIZE;
+            Asset asset;
+            const char* path;
+            size_t pathLength;
+            DecodeRecord(i, asset, path, pathLength);
+            if (
+                !IsWithin(DecodeUint32(record), pathLength, stringsSize)
+                || !IsWithin(DecodeUint32(record + 8), asset.contentTypeLength, stringsSize)
+                || !IsWithin(DecodeUint32(record + 16), asset.entityTagLength, stringsSize)
+                || !IsWithin(asset.identity.offset, asset.identity.size, size)
+                || !IsWithin(asset.brotli.offset, asset.brotli.size, size)
+                || !IsWithin(asset.gzip.offset, asset.gzip.size, size)
+            ) {
+                return false;
+            }
+            if (previousPath != nullptr) {
+                const auto comparison = memcmp(
+                    previousPath,
+                    path,
+                    std::min(previousPathLength, pathLength)
+                );
+                if (
+                    (comparison > 0)
+                    || (
+                        (comparison == 0)
+                        && (previousPathLength >= pathLength)
+                    )
+                ) {
+                    return false;
+                }
+            }
+            previousPath = path;
+            previousPathLength = pathLength;
+        }
+        return true;
+    }
+};
+
+AssetArchive::~AssetArchive() noexcept = default;
+
+AssetArchive::AssetArchive()
+    : impl_(new Impl())
+{
+}
+
+std::shared_ptr< const AssetArchive > AssetArchive::Open(
+    const std::string& path,
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
+) {
+    const auto reportError = [&](const char* problem){
+        diagnosticMessageDelegate(
+            "AssetArchive",
+            SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+            StringExtensions::sprintf(
+                "archive '%s' %s",
+                path.c_str(),
+                problem
+            )
+        );
+    };
+    FileInfo fileInfo;
+    if (
+        !GetFileInfo(path, fileInfo)
+        || fileInfo.isDirectory
+    ) {
+        reportError("not found");
+        return nullptr;
+    }
+    if (fileInfo.size < HEADER_SIZE) {
+        reportError("is truncated");
+        return nullptr;
+    }
+    std::shared_ptr< AssetArchive > archive(new AssetArchive());
+    archive->impl_->path = path;
+    archive->impl_->mapping = FileMapping::Map(
+        path,
+        (size_t)fileInfo.size,
+        diagnosticMessageDelegate
+    );
+    if (archive->impl_->mapping == nullptr) {
+        reportError("could not be mapped");
+        return nullptr;
+    }
+    const auto data = archive->impl_->mapping->GetData();
+    const auto size = archive->impl_->mapping->GetSize();
+    if (
+        (memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+        || (DecodeUint32(data + 8) != VERSION)
+    ) {
+        reportError("is not a supported asset archive");
+        return nullptr;
+    }
+    archive->impl_->assetCount = DecodeUint32(data + 12);
+    const auto stringsOffset = DecodeUint64(data + 16);
+    const auto stringsSize = DecodeUint64(data + 24);
+    if (
+        !IsWithin(HEADER_SIZE, (uint64_t)archive->impl_->assetCount * RECORD_SIZE, size)
+        || !IsWithin(stringsOffset, stringsSize, size)
+    ) {
+        reportError("is truncated");
+        return nullptr;
+    }
+    archive->impl_->index = data + HEADER_SIZE;
+    archive->impl_->strings = data + stringsOffset;
+    if (!archive->impl_->CheckIndex(stringsSize)) {
+        reportError("has a corrupt index");
+        return nullptr;
+    }
+    diagnosticMessageDelegate(
+        "AssetArchive",
+        0,
+        StringExtensions::sprintf(
+            "opened archive '%s' (%zu assets, %zu bytes)",
+            path.c_str(),
+            archive->impl_->assetCount,
+            size
+        )
+    );
+    return archive;
+}
+
+const std::string& AssetArchive::GetPath() const {
+    return impl_->path;
+}
+
+size_t AssetArchive::GetAssetCount() const {
+    return impl_->assetCount;
+}
+
+bool AssetArchive::Find(
+    const std::string& path,
+    Asset& asset
+) const {
+    size_t low = 0;
+    size_t high = impl_->assetCount;
+    while (low < high) {
+        const auto middle = low + (high - low) / 2;
+        const char* middlePath;
+        size_t middlePathLength;
+        impl_->DecodeRecord(middle, asset, middlePath, middlePathLength);
+        auto comparison = memcmp(
+            path.data(),
+            middlePath,
+            std::min(path.length(), middlePathLength)
+        );
+        if (comparison == 0) {
+            if (path.length() == middlePathLength) {
+                return true;
+            }
+            comparison = ((path.length() < middlePathLength) ? -1 : 1);
+        }
+        if (comparison < 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr< const FileMapping > AssetArchive::GetBlob(const Blob& blob) const {
+    return FileMapping::Slice(impl_->mapping, blob.offset, blob.size);
+}
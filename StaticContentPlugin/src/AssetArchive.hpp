@@ -0,0 +1,262 @@
+#ifndef STATIC_CONTENT_PLUGIN_ASSET_ARCHIVE_HPP
+#define STATIC_CONTENT_PLUGIN_ASSET_ARCHIVE_HPP
+
+/**
+ * @file AssetArchive.hpp
+ *
+ * This module declares the AssetArchive class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "FileMapping.hpp"
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <SystemAbstractions/DiagnosticsSender.hpp>
+
+/**
+ * This class provides access to a packed asset archive, which holds
+ * a whole tree of static files in a single file, along with everything
+ * needed to serve them, so that serving a file costs a lookup in memory
+ * rather than a series of system calls.  Archives are made with the
+ * PackStaticContent tool, and are memory-mapped when opened.
+ *
+ * All integers in an archive are little-endian.  An archive begins with
+ * a header:
+ * - magic (8 bytes): "SCPAK\0\0\0"
+ * - version (uint32): 1
+ * - asset count (uint32)
+ * - string table offset (uint64)
+ * - string table size (uint64)
+ *
+ * The header is followed by the index, which holds one record for each
+ * asset, sorted by path (compared byte-wise):
+ * - path offset and length within the string table (uint32, uint32)
+ * - content type offset and length within the string table
+ *   (uint32, uint32)
+ * - entity tag offset and length within the string table
+ *   (uint32, uint32)
+ * - flags (uint32): bit 0 set if the content type is compressible
+ * - reserved (uint32): 0
+ * - last modified time, in seconds since the UNIX epoch (int64)
+ * - offset and size of the contents of the asset (uint64, uint64)
+ * - offset and size of the contents compressed with "br"
+ *   (uint64, uint64), or zeroes if not present
+ * - offset and size of the contents compressed with "gzip"
+ *   (uint64, uint64), or zeroes if not present
+ *
+ * The contents of the assets and the string table follow, in any order.
+ * Paths are relative to the root of the archive, with "/" separating
+ * their segments.
+ */
+class AssetArchive {
+    // Constants
+public:
+    /**
+     * This is the magic number at the beginning of every archive.
+     */
+    static constexpr char MAGIC[8] = {'S', 'C', 'P', 'A', 'K', 0, 0, 0};
+
+    /**
+     * This is the version of the archive format.
+     */
+    static constexpr uint32_t VERSION = 1;
+
+    /**
+     * This is the size of the archive header, in bytes.
+     */
+    static constexpr size_t HEADER_SIZE = 32;
+
+    /**
+     * This is the size of each record in the archive index, in bytes.
+     */
+    static constexpr size_t RECORD_SIZE = 88;
+
+    /**
+     * This flag is set in the record of an asset whose content type
+     * is compressible.
+     */
+    static constexpr uint32_t FLAG_COMPRESSIBLE = 1;
+
+    // Types
+public:
+    /**
+     * This identifies a range of bytes within the archive.
+     */
+    struct Blob {
+        /**
+         * This is the offset of the first byte of the range.
+         */
+        uint64_t offset = 0;
+
+        /**
+         * This is the number of bytes in the range.
+         */
+        uint64_t size = 0;
+    };
+
+    /**
+     * This describes an asset in the archive.  The strings it refers
+     * to are held in the archive, and remain valid for as long as the
+     * archive is open.
+     */
+    struct Asset {
+        /**
+         * This points to the content type of the asset.
+         */
+        const char* contentType = nullptr;
+
+        /**
+         * This is the length of the content type of the asset.
+         */
+        size_t contentTypeLength = 0;
+
+        /**
+         * This points to the entity tag of the asset.
+         */
+        const char* entityTag = nullptr;
+
+        /**
+         * This is the length of the entity tag of the asset.
+         */
+        size_t entityTagLength = 0;
+
+        /**
+         * This indicates whether or not the asset is of a type
+         * which benefits from being compressed.
+         */
+        bool compressible = false;
+
+        /**
+         * This is the time the asset was last modified, in seconds
+         * since the UNIX epoch.
+         */
+        int64_t lastModifiedTime = 0;
+
+        /**
+         * This locates the contents of the asset.
+         */
+        Blob identity;
+
+        /**
+         * This locates the contents of the asset compressed with "br",
+         * if present.
+         */
+        Blob brotli;
+
+        /**
+         * This locates the contents of the asset compressed with "gzip",
+         * if present.
+         */
+        Blob gzip;
+    };
+
+    // Lifecycle Methods
+public:
+    ~AssetArchive() noexcept;
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive(AssetArchive&&) noexcept = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+    AssetArchive& operator=(AssetArchive&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This function opens the archive at the given path, mapping it into
+     * memory and checking that it's well-formed.
+     *
+     * @param[in] path
+     *     This is the path of the archive to open.
+     *
+     * @param[in] diagnosticMessageDelegate
+     *     This is the function to call to publish any diagnostic messages.
+     *
+     * @return
+     *     The opened archive is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the archive could not be opened,
+     *     or is not well-formed.
+     */
+    static std::shared_ptr< const AssetArchive > Open(
+        const std::string& path,
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
+    );
+
+    /**
+     * This method returns the path of the archive.
+     *
+     * @return
+     *     The path of the archive is returned.
+     */
+    const std::string& GetPath() const;
+
+    /**
+     * This method returns the number of assets in the archive.
+     *
+     * @return
+     *     The number of assets in the archive is returned.
+     */
+    size_t GetAssetCount() const;
+
+    /**
+     * This method looks up the asset with the given path.
+     * No memory is allocated.
+     *
+     * @param[in] path
+     *     This is the path of the asset, relative to the root
+     *     of the archive.
+     *
+     * @param[out] asset
+     *     This is where to store the description of the asset.
+     *
+     * @return
+     *     An indication of whether or not the asset was found is returned.
+     */
+    bool Find(
+        const std::string& path,
+        Asset& asset
+    ) const;
+
+    /**
+     * This method returns a view of the given range of the archive,
+     * which keeps the archive mapped for as long as the view exists.
+     *
+     * @param[in] blob
+     *     This identifies the range of the archive to return.
+     *
+     * @return
+     *     The view of the range of the archive is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the range is empty.
+     */
+    std::shared_ptr< const FileMapping > GetBlob(const Blob& blob) const;
+
+    // Private Methods
+private:
+    /**
+     * This is the default constructor of the class.  It's private
+     * because archives are made only by the Open function.
+     */
+    AssetArchive();
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* STATIC_CONTENT_PLUGIN_ASSET_ARCHIVE_HPP */
@@ -0,0 +1,382 @@
+/**
+ * @file AssetPacker.cpp
+ *
+ * This module contains the implementation of the function used to pack
+ * a directory tree into an asset archive.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "AssetArchive.hpp"
+#include "AssetPacker.hpp"
+#include "FileInfo.hpp"
+#include "MimeTypes.hpp"
+
+#include <algorithm>
+#include <Hash/Sha1.hpp>
+#include <Hash/Templates.hpp>
+#include <inttypes.h>
+#include <set>
+#include <stdint.h>
+#include <StringExtensions/StringExtensions.hpp>
+#include <SystemAbstractions/File.hpp>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the content type given to files whose extensions
+     * aren't recognized.
+     */
+    constexpr const char* DEFAULT_CONTENT_TYPE = "application/octet-stream";
+
+    /**
+     * This function appends the given 32-bit unsigned integer to the
+     * given string, in little-endian order.
+     *
+     * @param[in,out] output
+     *     This is the string to which to append the integer.
+     *
+     * @param[in] value
+     *     This is the integer to append.
+     */
+    void EncodeUint32(
+        std::string& output,
+        uint32_t value
+    ) {
+        for (size_t i = 0; i < 4; ++i) {
+            output.push_back((char)((value >> (i * 8)) & 0xFF));
+        }
+    }
+
+    /**
+     * This function appends the given 64-bit unsigned integer to the
+     * given string, in little-endian order.
+     *
+     * @param[in,out] output
+     *     This is the string to which to append the integer.
+     *
+     * @param[in] value
+     *     This is the integer to append.
+     */
+    void EncodeUint64(
+        std::string& output,
+        uint64_t value
+    ) {
+        EncodeUint32(output, (uint32_t)(value & 0xFFFFFFFF));
+        EncodeUint32(output, (uint32_t)(value >> 32));
+    }
+
+    /**
+     * This function finds all the files in the given directory tree.
+     *
+     * @param[in] root
+     *     This is the path of the directory at the root of the tree.
+     *
+     * @return
+     *     The paths of the files found, relative to the root of
+     *     the tree, are returned, sorted byte-wise.
+     */
+    std::vector< std::string > FindFiles(const std::string& root) {
+        std::vector< std::string > files;
+        std::set< uint64_t > seen;
+        std::vector< std::string > unvisited{root};
+        while (!unvisited.empty()) {
+            const auto directory = std::move(unvisited.back());
+            unvisited.pop_back();
+            FileInfo directoryInfo;
+            if (
+                !GetFileInfo(directory, directoryInfo)
+                || !seen.insert(directoryInfo.inode).second
+            ) {
+                continue;
+            }
+            std::vector< std::string > children;
+            SystemAbstractions::File::ListDirectory(directory, children);
+            for (const auto& child: children) {
+                FileInfo fileInfo;
+                if (!GetFileInfo(child, fileInfo)) {
+                    continue;
+                }
+                if (fileInfo.isDirectory) {
+                    unvisited.push_back(child);
+                } else {
+                    files.push_back(child.substr(root.length() + 1));
+                }
+            }
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    /**
+     * This function looks up the MIME type of the file with the given path.
+     *
+     * @param[in] path
+     *     This is the path of the file.
+     *
+     * @param[out] contentType
+     *     This is where to store the content type of the file.
+     *
+     * @param[out] compressible
+     *     This is where to store an indication of whether or not
+     *     the file is of a type which benefits from being compressed.
+     */
+    void DetermineContentType(
+        const std::string& path,
+        std::string& contentType,
+        bool& compressible
+    ) {
+        contentType = DEFAULT_CONTENT_TYPE;
+        compressible = false;
+        const auto delimiter = path.find_last_of("/.");
+        if (
+            (delimiter == std::string::npos)
+            || (path[delimiter] != '.')
+        ) {
+            return;
+        }
+        const auto mimeType = FindMimeType(
+            path.c_str() + delimiter + 1,
+            path.length() - delimiter - 1
+        );
+        if (mimeType != nullptr) {
+            contentType = mimeType->contentType;
+            compressible = mimeType->compressible;
+        }
+    }
+
+    /**
+     * This holds the state of an archive being written.
+     */
+    struct ArchiveWriter {
+        /**
+         * This is the archive file being written.
+         */
+        SystemAbstractions::File file;
+
+        /**
+         * This is the offset at which to write the next contents
+         * into the archive.
+         */
+        uint64_t offset = 0;
+
+        /**
+         * This holds the string table of the archive.
+         */
+        std::string strings;
+
+        /**
+         * This holds the index of the archive.
+         */
+        std::string index;
+
+        /**
+         * This is the constructor of the structure.
+         *
+         * @param[in] path
+         *     This is the path of the archive file.
+         */
+        explicit ArchiveWriter(const std::string& path)
+            : file(path)
+        {
+        }
+
+        /**
+         * This method appends the given data to the archive.
+         *
+         * @param[in] data
+         *     This is the data to append.
+         *
+         * @return
+         *     An indication of whether or not the data was
+         *     written successfully is returned.
+         */
+        bool Append(const std::string& data) {
+            if (file.Write(data.data(), data.length()) != data.length()) {
+                return false;
+            }
+            offset += data.length();
+            return true;
+        }
+
+        /**
+         * This method adds the given string to the string table,
+         * and its location to the index.
+         *
+         * @param[in] value
+         *     This is the string to add.
+         */
+        void AddString(const std::string& value) {
+            EncodeUint32(index, (uint32_t)strings.length());
+            EncodeUint32(index, (uint32_t)value.length());
+            strings += value;
+        }
+
+        /**
+         * This method appends the given contents to the archive,
+         * and adds their location to the index.
+         *
+         * @param[in] contents
+         *     These are the contents to add.
+         *
+         * @return
+         *     An indication of whether or not the contents
+         *     were written successfully is returned.
+         */
+        bool AddContents(const std::string& contents) {
+            EncodeUint64(index, contents.empty() ? 0 : offset);
+            EncodeUint64(index, contents.length());
+            return Append(contents);
+        }
+    };
+
+}
+
+bool PackAssets(
+    const std::string& root,
+    const std::string& archivePath,
+    const CompressionSettings& compression,
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
+) {
+    const auto files = FindFiles(root);
+    ArchiveWriter writer(archivePath);
+    if (
+        !writer.file.OpenReadWrite()
+        || !writer.file.SetSize(0)
+    ) {
+        diagnosticMessageDelegate(
+            "AssetPacker",
+            SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+            StringExtensions::sprintf(
+                "unable to create archive '%s'",
+                archivePath.c_str()
+            )
+        );
+        return false;
+    }
+
+    // Leave room for the header and index, which are written last.
+    const auto indexSize = files.size() * AssetArchive::RECORD_SIZE;
+    if (!writer.Append(std::string(AssetArchive::HEADER_SIZE + indexSize, '\0'))) {
+        return false;
+    }
+
+    // Add each file.
+    uint64_t identityBytes = 0;
+    for (const auto& relativePath: files) {
+        const auto path = root + "/" + relativePath;
+        FileInfo fileInfo;
+        SystemAbstractions::File file(path);
+        std::string content;
+        if (
+            !GetFileInfo(path, fileInfo)
+            || !file.OpenReadOnly()
+        ) {
+            diagnosticMessageDelegate(
+                "AssetPacker",
+                SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                StringExtensions::sprintf(
+                    "unable to open file '%s'",
+                    path.c_str()
+                )
+            );
+            return false;
+        }
+        content.resize((size_t)fileInfo.size);
+        if (file.Read(&content[0], content.length()) != content.length()) {
+            diagnosticMessageDelegate(
+                "AssetPacker",
+                SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                StringExtensions::sprintf(
+                    "unable to read file '%s'",
+                    path.c_str()
+                )
+            );
+            return false;
+        }
+        file.Close();
+        std::string contentType;
+        bool compressible;
+        DetermineContentType(relativePath, contentType, compressible);
+        std::string brotli, gzip;
+        if (compressible) {
+            for (const auto& coding: compression.codings) {
+                std::string* variant = nullptr;
+                if (coding == "br") {
+                    variant = &brotli;
+                } else if (coding == "gzip") {
+                    variant = &gzip;
+                }
+                if (
+                    (variant == nullptr)
+                    || !Compress(coding, compression, content.data(), content.length(), *variant)
+                    || (variant->length() >= content.length())
+                ) {
+                    if (variant != nullptr) {
+                        variant->clear();
+                    }
+                }
+            }
+        }
+        writer.AddString(relativePath);
+        writer.AddString(contentType);
+        writer.AddString(Hash::StringToString< Hash::Sha1 >(content));
+        EncodeUint32(writer.index, compressible ? AssetArchive::FLAG_COMPRESSIBLE : 0);
+        EncodeUint32(writer.index, 0);
+        EncodeUint64(writer.index, (uint64_t)fileInfo.lastModifiedTime);
+        if (
+            !writer.AddContents(content)
+            || !writer.AddContents(brotli)
+            || !writer.AddContents(gzip)
+        ) {
+            break;
+        }
+        identityBytes += content.length();
+    }
+
+    // Finish with the string table, and then go back
+    // and fill in the header and index.
+    const auto stringsOffset = writer.offset;
+    std::string header(AssetArchive::MAGIC, sizeof(AssetArchive::MAGIC));
+    EncodeUint32(header, AssetArchive::VERSION);
+    EncodeUint32(header, (uint32_t)files.size());
+    EncodeUint64(header, stringsOffset);
+    EncodeUint64(header, writer.strings.length());
+    bool written = (
+        (writer.index.length() == indexSize)
+        && writer.Append(writer.strings)
+    );
+    const auto archiveSize = writer.offset;
+    if (written) {
+        writer.file.SetPosition(0);
+        written = (
+            writer.Append(header)
+            && writer.Append(writer.index)
+        );
+    }
+    if (!written) {
+        diagnosticMessageDelegate(
+            "AssetPacker",
+            SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+            StringExtensions::sprintf(
+                "unable to write archive '%s'",
+                archivePath.c_str()
+            )
+        );
+        return false;
+    }
+    diagnosticMessageDelegate(
+        "AssetPacker",
+        0,
+        StringExtensions::sprintf(
+            "packed %zu files (%" PRIu64 " bytes) from '%s' into '%s' (%" PRIu64 " bytes)",
+            files.size(),
+            identityBytes,
+            root.c_str(),
+            archivePath.c_str(),
+            archiveSize
+        )
+    );
+    return true;
+}
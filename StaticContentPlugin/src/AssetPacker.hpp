@@ -0,0 +1,48 @@
+#ifndef STATIC_CONTENT_PLUGIN_ASSET_PACKER_HPP
+#define STATIC_CONTENT_PLUGIN_ASSET_PACKER_HPP
+
+/**
+ * @file AssetPacker.hpp
+ *
+ * This module declares the function used to pack a directory tree
+ * into an asset archive.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "Compression.hpp"
+
+#include <string>
+#include <SystemAbstractions/DiagnosticsSender.hpp>
+
+/**
+ * This function packs all the files in the given directory tree into an
+ * asset archive (see AssetArchive), computing the entity tag and content
+ * type of each file, and compressing files of compressible types with
+ * each of the given content codings the archive format supports ("br"
+ * and "gzip"), keeping compressed contents only if they're smaller.
+ *
+ * @param[in] root
+ *     This is the path of the directory tree to pack.
+ *
+ * @param[in] archivePath
+ *     This is the path of the archive to create or replace.
+ *
+ * @param[in] compression
+ *     These are the settings to use to compress files.
+ *
+ * @param[in] diagnosticMessageDelegate
+ *     This is the function to call to publish any diagnostic messages.
+ *
+ * @return
+ *     An indication of whether or not the archive was
+ *     made successfully is returned.
+ */
+bool PackAssets(
+    const std::string& root,
+    const std::string& archivePath,
+    const CompressionSettings& compression,
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
+);
+
+#endif /* STATIC_CONTENT_PLUGIN_ASSET_PACKER_HPP */
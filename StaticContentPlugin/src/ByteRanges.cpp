@@ -0,0 +1,153 @@
+/**
+ * @file ByteRanges.cpp
+ *
+ * This module contains the implementation of the function
+ * used to parse the "Range" header of a request.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "ByteRanges.hpp"
+
+#include <algorithm>
+#include <StringExtensions/StringExtensions.hpp>
+
+namespace {
+
+    /**
+     * This function parses the given string as a non-negative
+     * decimal integer.
+     *
+     * @param[in] text
+     *     This is the string to parse.
+     *
+     * @param[out] value
+     *     This is where to store the parsed value.
+     *
+     * @return
+     *     An indication of whether or not the string was a valid
+     *     non-negative decimal integer is returned.
+     */
+    bool ParseInteger(
+        const std::string& text,
+        uint64_t& value
+    ) {
+        if (text.empty()) {
+            return false;
+        }
+        value = 0;
+        for (const auto c: text) {
+            if (
+                (c < '0')
+                || (c > '9')
+            ) {
+                return false;
+            }
+            const auto digit = (uint64_t)(c - '0');
+            if (value > (UINT64_MAX - digit) / 10) {
+                return false;
+            }
+            value = value * 10 + digit;
+        }
+        return true;
+    }
+
+}
+
+bool ParseByteRanges(
+    const std::string& rangeHeader,
+    uint64_t size,
+    size_t maxRanges,
+    std::vector< ByteRange >& ranges
+) {
+    ranges.clear();
+    const auto header = StringExtensions::Trim(rangeHeader);
+    static const std::string unit = "bytes=";
+    if (header.compare(0, unit.length(), unit) != 0) {
+        return false;
+    }
+    const auto specs = StringExtensions::Split(header.substr(unit.length()), ',');
+    if (specs.size() > maxRanges) {
+        return false;
+    }
+    for (const auto& rawSpec: specs) {
+        const auto spec = StringExtensions::Trim(rawSpec);
+        const auto delimiter = spec.find('-');
+        if (delimiter == std::string::npos) {
+            return false;
+        }
+        const auto firstText = spec.substr(0, delimiter);
+        const auto lastText = spec.substr(delimiter + 1);
+        ByteRange range;
+        if (firstText.empty()) {
+            // suffix-byte-range-spec: the last N bytes
+            uint64_t suffixLength;
+            if (!ParseInteger(lastText, suffixLength)) {
+                return false;
+            }
+            if (
+                (suffixLength == 0)
+                || (size == 0)
+            ) {
+                continue;
+            }
+            range.first = ((suffixLength < size) ? (size - suffixLength) : 0);
+            range.last = size - 1;
+        } else {
+            // byte-range-spec: from the first byte to the last byte
+            // (or end of the resource)
+            if (!ParseInteger(firstText, range.first)) {
+                return false;
+            }
+            if (lastText.empty()) {
+                range.last = size - 1;
+            } else {
+                if (!ParseInteger(lastText, range.last)) {
+                    return false;
+                }
+                if (range.last < range.first) {
+                    return false;
+                }
+                if (range.last >= size) {
+                    range.last = size - 1;
+                }
+            }
+            if (range.first >= size) {
+                continue;
+            }
+        }
+        ranges.push_back(range);
+    }
+
+    // Refuse requests asking for more bytes in all than the resource
+    // holds, since they can only be asking for some bytes more than once.
+    // Otherwise, coalesce ranges which overlap or touch, so that each
+    // byte is served at most once.
+    uint64_t totalLength = 0;
+    for (const auto& range: ranges) {
+        totalLength += range.GetLength();
+        if (totalLength > size) {
+            ranges.clear();
+            return false;
+        }
+    }
+    if (ranges.size() > 1) {
+        std::sort(
+            ranges.begin(),
+            ranges.end(),
+            [](const ByteRange& lhs, const ByteRange& rhs){
+                return lhs.first < rhs.first;
+            }
+        );
+        auto coalesced = ranges.begin();
+        for (auto range = ranges.begin() + 1; range != ranges.end(); ++range) {
+            if (range->first <= coalesced->last + 1) {
+                coalesced->last = std::max(coalesced->last, range->last);
+            } else {
+                *++coalesced = *range;
+            }
+        }
+        ranges.erase(coalesced + 1, ranges.end());
+    }
+    return true;
+}
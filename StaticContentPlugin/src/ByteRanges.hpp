@@ -0,0 +1,78 @@
+#ifndef STATIC_CONTENT_PLUGIN_BYTE_RANGES_HPP
+#define STATIC_CONTENT_PLUGIN_BYTE_RANGES_HPP
+
+/**
+ * @file ByteRanges.hpp
+ *
+ * This module declares the ByteRange structure and the function
+ * used to parse the "Range" header of a request.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * This identifies a contiguous range of bytes within a resource.
+ */
+struct ByteRange {
+    /**
+     * This is the offset of the first byte in the range.
+     */
+    uint64_t first = 0;
+
+    /**
+     * This is the offset of the last byte in the range.
+     */
+    uint64_t last = 0;
+
+    // Methods
+
+    /**
+     * This method returns the number of bytes in the range.
+     *
+     * @return
+     *     The number of bytes in the range is returned.
+     */
+    uint64_t GetLength() const {
+        return last - first + 1;
+    }
+};
+
+/**
+ * This function parses the value of the "Range" header of a request,
+ * according to RFC 7233, for a resource of the given size.
+ *
+ * @param[in] rangeHeader
+ *     This is the value of the "Range" header of the request.
+ *
+ * @param[in] size
+ *     This is the size of the resource, in bytes.
+ *
+ * @param[in] maxRanges
+ *     This is the maximum number of ranges the request may ask for.
+ *     Requests for more ranges are treated as if they had no "Range"
+ *     header at all.
+ *
+ * @param[out] ranges
+ *     This is where to store the satisfiable ranges requested,
+ *     clamped to the size of the resource, in order, with ranges which
+ *     overlap or touch coalesced.  If the request is valid but none of
+ *     the ranges requested is satisfiable, this is empty.
+ *
+ * @return
+ *     An indication of whether or not the header is a valid request for
+ *     byte ranges that should be honored is returned.  If not (including
+ *     when the ranges requested add up to more than the whole resource),
+ *     the header should be ignored and the whole resource served.
+ */
+bool ParseByteRanges(
+    const std::string& rangeHeader,
+    uint64_t size,
+    size_t maxRanges,
+    std::vector< ByteRange >& ranges
+);
+
+#endif /* STATIC_CONTENT_PLUGIN_BYTE_RANGES_HPP */
@@ -0,0 +1,202 @@
+/**
+ * @file Compression.cpp
+ *
+ * This module contains the implementation of the functions used to apply
+ * content codings to resources served by the plug-in.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "Compression.hpp"
+
+#include <stdlib.h>
+#include <StringExtensions/StringExtensions.hpp>
+#include <zlib.h>
+
+#ifdef STATIC_CONTENT_PLUGIN_HAVE_BROTLI
+#include <brotli/encode.h>
+#endif /* STATIC_CONTENT_PLUGIN_HAVE_BROTLI */
+
+namespace {
+
+    /**
+     * This function compresses the given data using the "gzip" coding.
+     *
+     * @param[in] level
+     *     This is the compression level to use.
+     *
+     * @param[in] input
+     *     This points to the data to compress.
+     *
+     * @param[in] inputSize
+     *     This is the number of bytes of data to compress.
+     *
+     * @param[out] output
+     *     This is where to store the compressed data.
+     *
+     * @return
+     *     An indication of whether or not the data was compressed
+     *     successfully is returned.
+     */
+    bool Gzip(
+        int level,
+        const char* input,
+        size_t inputSize,
+        std::string& output
+    ) {
+        z_stream stream = {};
+        if (
+            deflateInit2(
+                &stream,
+                level,
+                Z_DEFLATED,
+                15 + 16, // maximum window size, with gzip header and trailer
+                8,
+                Z_DEFAULT_STRATEGY
+            ) != Z_OK
+        ) {
+            return false;
+        }
+        output.resize(deflateBound(&stream, (uLong)inputSize));
+        stream.next_in = (Bytef*)input;
+        stream.avail_in = (uInt)inputSize;
+        stream.next_out = (Bytef*)&output[0];
+        stream.avail_out = (uInt)output.length();
+        const auto result = deflate(&stream, Z_FINISH);
+        output.resize(stream.total_out);
+        (void)deflateEnd(&stream);
+        return (result == Z_STREAM_END);
+    }
+
+#ifdef STATIC_CONTENT_PLUGIN_HAVE_BROTLI
+    /**
+     * This function compresses the given data using the "br" coding.
+     *
+     * @param[in] quality
+     *     This is the compression quality to use.
+     *
+     * @param[in] input
+     *     This points to the data to compress.
+     *
+     * @param[in] inputSize
+     *     This is the number of bytes of data to compress.
+     *
+     * @param[out] output
+     *     This is where to store the compressed data.
+     *
+     * @return
+     *     An indication of whether or not the data was compressed
+     *     successfully is returned.
+     */
+    bool Brotli(
+        int quality,
+        const char* input,
+        size_t inputSize,
+        std::string& output
+    ) {
+        size_t outputSize = BrotliEncoderMaxCompressedSize(inputSize);
+        if (outputSize == 0) {
+            return false;
+        }
+        output.resize(outputSize);
+        if (
+            !BrotliEncoderCompress(
+                quality,
+                BROTLI_DEFAULT_WINDOW,
+                BROTLI_MODE_TEXT,
+                inputSize,
+                (const uint8_t*)input,
+                &outputSize,
+                (uint8_t*)&output[0]
+            )
+        ) {
+            return false;
+        }
+        output.resize(outputSize);
+        return true;
+    }
+#endif /* STATIC_CONTENT_PLUGIN_HAVE_BROTLI */
+
+}
+
+bool IsContentCodingSupported(const std::string& coding) {
+    if (coding == "gzip") {
+        return true;
+    }
+#ifdef STATIC_CONTENT_PLUGIN_HAVE_BROTLI
+    if (coding == "br") {
+        return true;
+    }
+#endif /* STATIC_CONTENT_PLUGIN_HAVE_BROTLI */
+    return false;
+}
+
+std::string NegotiateContentCoding(
+    const std::string& acceptEncoding,
+    const std::vector< std::string >& codings
+) {
+    // Parse the quality value the client gives each coding it lists.
+    // Codings listed without a quality value have a quality of 1.
+    std::vector< std::pair< std::string, double > > qualities;
+    for (const auto& element: StringExtensions::Split(acceptEncoding, ',')) {
+        const auto parameters = StringExtensions::Split(element, ';');
+        const auto name = StringExtensions::ToLower(StringExtensions::Trim(parameters[0]));
+        if (name.empty()) {
+            continue;
+        }
+        double quality = 1.0;
+        for (size_t i = 1; i < parameters.size(); ++i) {
+            const auto parameter = StringExtensions::Trim(parameters[i]);
+            if (
+                (parameter.length() >= 2)
+                && ((parameter[0] == 'q') || (parameter[0] == 'Q'))
+                && (parameter[1] == '=')
+            ) {
+                quality = strtod(parameter.c_str() + 2, NULL);
+            }
+        }
+        qualities.emplace_back(name, quality);
+    }
+
+    // Pick the available coding with the highest quality value,
+    // breaking ties according to our order of preference.
+    std::string bestCoding;
+    double bestQuality = 0.0;
+    for (const auto& coding: codings) {
+        double quality = -1.0;
+        double wildcardQuality = -1.0;
+        for (const auto& entry: qualities) {
+            if (entry.first == coding) {
+                quality = entry.second;
+            } else if (entry.first == "*") {
+                wildcardQuality = entry.second;
+            }
+        }
+        if (quality < 0.0) {
+            quality = wildcardQuality;
+        }
+        if (quality > bestQuality) {
+            bestCoding = coding;
+            bestQuality = quality;
+        }
+    }
+    return bestCoding;
+}
+
+bool Compress(
+    const std::string& coding,
+    const CompressionSettings& settings,
+    const char* input,
+    size_t inputSize,
+    std::string& output
+) {
+    if (coding == "gzip") {
+        return Gzip(settings.gzipLevel, input, inputSize, output);
+    }
+#ifdef STATIC_CONTENT_PLUGIN_HAVE_BROTLI
+    if (coding == "br") {
+        return Brotli(settings.brotliQuality, input, inputSize, output);
+    }
+#endif /* STATIC_CONTENT_PLUGIN_HAVE_BROTLI */
+    return false;
+}
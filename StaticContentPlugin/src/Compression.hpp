@@ -0,0 +1,108 @@
+#ifndef STATIC_CONTENT_PLUGIN_COMPRESSION_HPP
+#define STATIC_CONTENT_PLUGIN_COMPRESSION_HPP
+
+/**
+ * @file Compression.hpp
+ *
+ * This module declares the functions used to apply content codings
+ * to resources served by the plug-in.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/**
+ * This holds the settings which control how resources are compressed.
+ */
+struct CompressionSettings {
+    /**
+     * These are the names of the content codings which may be applied,
+     * in order of preference.
+     */
+    std::vector< std::string > codings;
+
+    /**
+     * This is the compression level to use for the "gzip" coding,
+     * from 1 (fastest) to 9 (smallest).
+     */
+    int gzipLevel = 6;
+
+    /**
+     * This is the compression quality to use for the "br" coding,
+     * from 0 (fastest) to 11 (smallest).
+     */
+    int brotliQuality = 5;
+};
+
+/**
+ * This function determines whether or not the given content coding
+ * is supported by this build of the plug-in.
+ *
+ * @param[in] coding
+ *     This is the name of the content coding to check.
+ *
+ * @return
+ *     An indication of whether or not the given content coding
+ *     is supported is returned.
+ */
+bool IsContentCodingSupported(const std::string& coding);
+
+/**
+ * This function selects the content coding to apply to a resource,
+ * given the value of the "Accept-Encoding" header of the request and
+ * the content codings available.  Quality values given by the client are
+ * respected, and ties are broken by the order of the available codings.
+ *
+ * @param[in] acceptEncoding
+ *     This is the value of the "Accept-Encoding" header of the request.
+ *
+ * @param[in] codings
+ *     These are the names of the available content codings,
+ *     in order of preference.
+ *
+ * @return
+ *     The name of the selected content coding is returned.
+ *
+ * @retval ""
+ *     This is returned if none of the available content codings
+ *     is acceptable to the client.
+ */
+std::string NegotiateContentCoding(
+    const std::string& acceptEncoding,
+    const std::vector< std::string >& codings
+);
+
+/**
+ * This function applies the given content coding to the given data.
+ *
+ * @param[in] coding
+ *     This is the name of the content coding to apply.
+ *
+ * @param[in] settings
+ *     These are the settings which control how resources are compressed.
+ *
+ * @param[in] input
+ *     This points to the data to compress.
+ *
+ * @param[in] inputSize
+ *     This is the number of bytes of data to compress.
+ *
+ * @param[out] output
+ *     This is where to store the compressed data.
+ *
+ * @return
+ *     An indication of whether or not the data was compressed
+ *     successfully is returned.
+ */
+bool Compress(
+    const std::string& coding,
+    const CompressionSettings& settings,
+    const char* input,
+    size_t inputSize,
+    std::string& output
+);
+
+#endif /* STATIC_CONTENT_PLUGIN_COMPRESSION_HPP */
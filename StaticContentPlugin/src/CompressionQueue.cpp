@@ -0,0 +1,194 @@
+/**
+ * @file CompressionQueue.cpp
+ *
+ * This module contains the implementation of the CompressionQueue class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "CompressionQueue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * This contains the private properties of the CompressionQueue class.
+ */
+struct CompressionQueue::Impl {
+    // Types
+
+    /**
+     * This holds a job waiting to be run, along with its key.
+     */
+    struct QueuedJob {
+        /**
+         * This identifies the job.
+         */
+        std::string key;
+
+        /**
+         * This is the function to run.
+         */
+        Job job;
+    };
+
+    // Properties
+
+    /**
+     * This is used to synchronize access to the queue.
+     */
+    std::mutex mutex;
+
+    /**
+     * This is used to wake up the threads when there are jobs to run,
+     * or when they should stop.
+     */
+    std::condition_variable wakeCondition;
+
+    /**
+     * This is the number of threads to run jobs on.
+     */
+    size_t numThreads = 1;
+
+    /**
+     * This is the largest share of processor time which
+     * each thread may spend running jobs.
+     */
+    double maxCpuShare = 1.0;
+
+    /**
+     * This is the largest number of jobs which may be waiting at once.
+     */
+    size_t maxJobs = 0;
+
+    /**
+     * These are the urgent jobs waiting to be run, in order.
+     */
+    std::deque< QueuedJob > urgentJobs;
+
+    /**
+     * These are the idle jobs waiting to be run, in order.
+     */
+    std::deque< QueuedJob > idleJobs;
+
+    /**
+     * These are the keys of the jobs waiting or running.
+     */
+    std::unordered_set< std::string > keys;
+
+    /**
+     * These are the threads running the jobs.
+     */
+    std::vector< std::thread > threads;
+
+    /**
+     * This flag indicates whether or not the threads should stop.
+     */
+    bool stop = false;
+
+    // Methods
+
+    /**
+     * This function is called in each thread.  It runs jobs, urgent ones
+     * first, resting after each one so as to keep within its share of
+     * processor time, until told to stop.
+     */
+    void Run() {
+        std::unique_lock< decltype(mutex) > lock(mutex);
+        while (!stop) {
+            auto& jobs = (urgentJobs.empty() ? idleJobs : urgentJobs);
+            if (jobs.empty()) {
+                wakeCondition.wait(lock);
+                continue;
+            }
+            const auto queuedJob = std::move(jobs.front());
+            jobs.pop_front();
+            lock.unlock();
+            const auto start = std::chrono::steady_clock::now();
+            queuedJob.job();
+            const auto worked = std::chrono::steady_clock::now() - start;
+            lock.lock();
+            (void)keys.erase(queuedJob.key);
+            if (maxCpuShare < 1.0) {
+                const auto rest = std::chrono::duration_cast< std::chrono::steady_clock::duration >(
+                    worked * ((1.0 - maxCpuShare) / maxCpuShare)
+                );
+                (void)wakeCondition.wait_for(
+                    lock,
+                    rest,
+                    [this]{ return stop; }
+                );
+            }
+        }
+    }
+};
+
+CompressionQueue::~CompressionQueue() noexcept {
+    Stop();
+}
+
+CompressionQueue::CompressionQueue(
+    size_t threads,
+    double maxCpuShare,
+    size_t maxJobs
+)
+    : impl_(new Impl())
+{
+    impl_->numThreads = std::max(threads, (size_t)1);
+    impl_->maxCpuShare = std::min(std::max(maxCpuShare, 0.01), 1.0);
+    impl_->maxJobs = maxJobs;
+}
+
+void CompressionQueue::Start() {
+    Stop();
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    impl_->stop = false;
+    for (size_t i = 0; i < impl_->numThreads; ++i) {
+        impl_->threads.emplace_back(&Impl::Run, impl_.get());
+    }
+}
+
+void CompressionQueue::Stop() {
+    std::vector< std::thread > threads;
+    {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->stop = true;
+        impl_->urgentJobs.clear();
+        impl_->idleJobs.clear();
+        impl_->keys.clear();
+        threads.swap(impl_->threads);
+        impl_->wakeCondition.notify_all();
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+}
+
+bool CompressionQueue::Submit(
+    const std::string& key,
+    Priority priority,
+    Job job
+) {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    if (
+        impl_->stop
+        || (impl_->urgentJobs.size() + impl_->idleJobs.size() >= impl_->maxJobs)
+        || !impl_->keys.insert(key).second
+    ) {
+        return false;
+    }
+    auto& jobs = (
+        (priority == Priority::Urgent)
+        ? impl_->urgentJobs
+        : impl_->idleJobs
+    );
+    jobs.push_back({key, std::move(job)});
+    impl_->wakeCondition.notify_one();
+    return true;
+}
@@ -0,0 +1,140 @@
+#ifndef STATIC_CONTENT_PLUGIN_COMPRESSION_QUEUE_HPP
+#define STATIC_CONTENT_PLUGIN_COMPRESSION_QUEUE_HPP
+
+/**
+ * @file CompressionQueue.hpp
+ *
+ * This module declares the CompressionQueue class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <functional>
+#include <memory>
+#include <stddef.h>
+#include <string>
+
+/**
+ * This class runs compression jobs on a pool of background threads,
+ * so that files can be compressed without holding up the requests
+ * which first call for them.
+ *
+ * Jobs come in two priorities.  Urgent jobs, such as compressing a file
+ * quickly for the first time, are run as soon as a thread is free.
+ * Idle jobs, such as compressing a file again more tightly, are only
+ * run while there are no urgent jobs waiting.
+ *
+ * Each job is identified by a key, and a job isn't queued if another
+ * job with the same key is already waiting or running.  The number of
+ * jobs waiting is also bounded; jobs queued beyond the bound are
+ * simply dropped, since they can always be queued again later.
+ *
+ * The share of processor time used by each thread is capped, by
+ * having the thread rest after each job for long enough that the
+ * time spent working is no more than the given share of the time
+ * which has passed.
+ */
+class CompressionQueue {
+    // Types
+public:
+    /**
+     * These are the priorities a job may have.
+     */
+    enum class Priority {
+        /**
+         * The job is run as soon as a thread is free.
+         */
+        Urgent,
+
+        /**
+         * The job is only run while no urgent jobs are waiting.
+         */
+        Idle,
+    };
+
+    /**
+     * This is the type of function run as a job.
+     */
+    typedef std::function< void() > Job;
+
+    // Lifecycle Methods
+public:
+    ~CompressionQueue() noexcept;
+    CompressionQueue(const CompressionQueue&) = delete;
+    CompressionQueue(CompressionQueue&&) noexcept = delete;
+    CompressionQueue& operator=(const CompressionQueue&) = delete;
+    CompressionQueue& operator=(CompressionQueue&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     *
+     * @param[in] threads
+     *     This is the number of threads to run jobs on.
+     *
+     * @param[in] maxCpuShare
+     *     This is the largest share of processor time, from 0 (exclusive)
+     *     to 1, which each thread may spend running jobs.
+     *
+     * @param[in] maxJobs
+     *     This is the largest number of jobs which may be waiting
+     *     to be run at once.
+     */
+    CompressionQueue(
+        size_t threads,
+        double maxCpuShare,
+        size_t maxJobs
+    );
+
+    /**
+     * This method starts the threads which run the jobs.
+     */
+    void Start();
+
+    /**
+     * This method stops the threads which run the jobs, after any
+     * jobs which are running finish.  Any jobs still waiting
+     * are dropped.
+     */
+    void Stop();
+
+    /**
+     * This method queues the given job to be run.
+     *
+     * @param[in] key
+     *     This identifies the job, so that it isn't queued again
+     *     while it's waiting or running.
+     *
+     * @param[in] priority
+     *     This is the priority of the job.
+     *
+     * @param[in] job
+     *     This is the function to run.
+     *
+     * @return
+     *     An indication of whether or not the job was queued
+     *     is returned.
+     */
+    bool Submit(
+        const std::string& key,
+        Priority priority,
+        Job job
+    );
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* STATIC_CONTENT_PLUGIN_COMPRESSION_QUEUE_HPP */
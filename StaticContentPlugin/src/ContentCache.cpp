@@ -0,0 +1,666 @@
+/**
+ * @file ContentCache.cpp
+ *
+ * This module contains the implementation of the ContentCache class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "ContentCache.hpp"
+#include "FrequencySketch.hpp"
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+    /**
+     * This is the number of bytes charged against the capacity of the
+     * cache for each entry, in addition to the bytes of the strings the
+     * entry holds, to account for the bookkeeping of the entry.
+     */
+    constexpr size_t ENTRY_OVERHEAD = 128;
+
+    /**
+     * This is the fraction of the capacity of the cache given to the
+     * window of new entries, when the W-TinyLFU policy is used.
+     */
+    constexpr double WINDOW_FRACTION = 0.01;
+
+    /**
+     * This is the typical number of bytes charged for an entry, used to
+     * estimate how many entries the cache holds in order to size the
+     * frequency sketch used by the W-TinyLFU policy.
+     */
+    constexpr size_t TYPICAL_ENTRY_COST = 4096;
+
+    /**
+     * This function computes the number of bytes to charge against the
+     * capacity of the cache in order to hold the given entry.
+     *
+     * @param[in] entry
+     *     This is the entry for which to compute the cost.
+     *
+     * @return
+     *     The number of bytes to charge for the entry is returned.
+     */
+    size_t ComputeCost(const ContentCache::Entry& entry) {
+        size_t cost = (
+            ENTRY_OVERHEAD
+            + entry.path.length()
+            + entry.entityTag.length()
+            + entry.contentType.length()
+        );
+        for (const auto& sidecar: entry.sidecars) {
+            cost += ENTRY_OVERHEAD + sidecar.first.length();
+        }
+        for (const auto& encoding: entry.encodings) {
+            cost += ENTRY_OVERHEAD + encoding.first.length();
+        }
+        if (entry.content != nullptr) {
+            cost += entry.content->length();
+        }
+        return cost;
+    }
+
+    /**
+     * This function computes the number of bytes to charge against the
+     * capacity of the cache in order to hold the given response template.
+     *
+     * @param[in] coding
+     *     This is the name of the content coding of the response.
+     *
+     * @param[in] response
+     *     This is the response template for which to compute the cost.
+     *
+     * @return
+     *     The number of bytes to charge for the response template
+     *     is returned.
+     */
+    size_t ComputeResponseCost(
+        const std::string& coding,
+        const Http::Response& response
+    ) {
+        return (
+            ENTRY_OVERHEAD
+            + coding.length()
+            + response.reasonPhrase.length()
+            + response.headers.GenerateRawHeaders().length()
+        );
+    }
+
+}
+
+/**
+ * This contains the private properties of the ContentCache class.
+ */
+struct ContentCache::Impl {
+    // Types
+
+    /**
+     * This is the type used to keep track of the order in which
+     * entries were last used, most recently used first.
+     */
+    typedef std::list< std::string > RecencyList;
+
+    /**
+     * This holds an entry in the cache along with its bookkeeping.
+     */
+    struct Slot {
+        /**
+         * This is the entry held in the slot.
+         */
+        std::shared_ptr< const Entry > entry;
+
+        /**
+         * These are the encoded variants of the contents of the file,
+         * keyed by content coding.
+         */
+        std::map< std::string, std::shared_ptr< const std::string > > variants;
+
+        /**
+         * These are the templates of the responses used to serve the
+         * file in full, keyed by content coding.
+         */
+        std::map< std::string, std::shared_ptr< const Http::Response > > responses;
+
+        /**
+         * This is the number of bytes charged for the entry,
+         * including its variants and response templates.
+         */
+        size_t cost = 0;
+
+        /**
+         * This is the position of the entry in the recency list
+         * (or the window list, if the entry is in the window).
+         */
+        RecencyList::iterator recency;
+
+        /**
+         * This indicates whether or not the entry is in the window
+         * of new entries, rather than the rest of the cache.
+         */
+        bool inWindow = false;
+
+        /**
+         * This indicates whether or not the entry was just pushed out
+         * of the window, and is waiting to be either admitted to the
+         * rest of the cache or turned away.
+         */
+        bool isCandidate = false;
+
+        /**
+         * This indicates whether or not the entry has been marked
+         * as current during the current generation of the cache.
+         */
+        bool isCurrent = false;
+    };
+
+    /**
+     * This is the type used to refer to an entry in the cache.
+     */
+    typedef std::unordered_map< std::string, Slot >::iterator SlotRef;
+
+    // Properties
+
+    /**
+     * This is used to synchronize access to the cache.
+     */
+    mutable std::mutex mutex;
+
+    /**
+     * This is the maximum number of bytes the cache may hold.
+     */
+    size_t capacity = 0;
+
+    /**
+     * This is the policy used to choose entries to evict.
+     */
+    EvictionPolicy policy = EvictionPolicy::Lru;
+
+    /**
+     * This is the number of bytes currently held by the cache.
+     */
+    size_t residentBytes = 0;
+
+    /**
+     * These are the entries in the cache, keyed by file system path.
+     */
+    std::unordered_map< std::string, Slot > slots;
+
+    /**
+     * This keeps track of the order in which entries were last used,
+     * most recently used first.  With the W-TinyLFU policy, this only
+     * covers the entries which aren't in the window.
+     */
+    RecencyList recency;
+
+    /**
+     * With the W-TinyLFU policy, this keeps track of the order in which
+     * the entries in the window were last used, most recently used first.
+     */
+    RecencyList window;
+
+    /**
+     * This is the maximum number of bytes the window may hold, before
+     * its least recently used entries are pushed out of it.
+     */
+    size_t windowCapacity = 0;
+
+    /**
+     * This is the number of bytes currently held in the window.
+     */
+    size_t windowBytes = 0;
+
+    /**
+     * With the W-TinyLFU policy, this estimates how often each file
+     * has been looked up recently.
+     */
+    std::unique_ptr< FrequencySketch > sketch;
+
+    /**
+     * This holds the counters of how well the cache is working.
+     */
+    Statistics statistics;
+
+    /**
+     * This is the current generation of the cache, which is advanced
+     * every time the cache is cleared.
+     */
+    uint64_t generation = 0;
+
+    // Methods
+
+    /**
+     * This method removes the given slot from the cache.
+     *
+     * @param[in] slot
+     *     This refers to the slot to remove.
+     */
+    void Erase(SlotRef slot) {
+        residentBytes -= slot->second.cost;
+        if (slot->second.inWindow) {
+            windowBytes -= slot->second.cost;
+            (void)window.erase(slot->second.recency);
+        } else {
+            (void)recency.erase(slot->second.recency);
+        }
+        (void)slots.erase(slot);
+    }
+
+    /**
+     * This method records a lookup of the given file, for the
+     * W-TinyLFU policy.
+     *
+     * @param[in] path
+     *     This is the file system path of the file looked up.
+     */
+    void RecordLookup(const std::string& path) {
+        if (sketch != nullptr) {
+            sketch->Record(path);
+        }
+    }
+
+    /**
+     * This method marks the given slot as the most recently used.
+     *
+     * @param[in] slot
+     *     This refers to the slot to mark.
+     */
+    void Touch(SlotRef slot) {
+        auto& list = (slot->second.inWindow ? window : recency);
+        list.splice(list.begin(), list, slot->second.recency);
+    }
+
+    /**
+     * This method adds the given charge to the given slot.
+     *
+     * @param[in] slot
+     *     This refers to the slot to charge.
+     *
+     * @param[in] cost
+     *     This is the number of bytes to charge.
+     */
+    void Charge(
+        SlotRef slot,
+        size_t cost
+    ) {
+        slot->second.cost += cost;
+        residentBytes += cost;
+        if (slot->second.inWindow) {
+            windowBytes += cost;
+        }
+    }
+
+    /**
+     * This method removes the given charge from the given slot.
+     *
+     * @param[in] slot
+     *     This refers to the slot to discharge.
+     *
+     * @param[in] cost
+     *     This is the number of bytes to discharge.
+     */
+    void Discharge(
+        SlotRef slot,
+        size_t cost
+    ) {
+        slot->second.cost -= cost;
+        residentBytes -= cost;
+        if (slot->second.inWindow) {
+            windowBytes -= cost;
+        }
+    }
+
+    /**
+     * This method finds the least recently used entry outside
+     * the window, other than any candidates for admission.
+     *
+     * @return
+     *     The entry found is returned, or the end of the slots
+     *     if there is no such entry.
+     */
+    SlotRef FindVictim() {
+        for (auto path = recency.rbegin(); path != recency.rend(); ++path) {
+            const auto slot = slots.find(*path);
+            if (!slot->second.isCandidate) {
+                return slot;
+            }
+        }
+        return slots.end();
+    }
+
+    /**
+     * This method evicts entries until the cache holds
+     * no more than its capacity.
+     *
+     * With the W-TinyLFU policy, entries which no longer fit in the window
+     * are moved out of it first, and become candidates for admission to
+     * the rest of the cache.  Each candidate is compared with the least
+     * recently used entry outside the window, and whichever of the two
+     * has been looked up less often recently is evicted.  An entry
+     * outside the window which has just grown is treated the same way.
+     *
+     * @param[in] grown
+     *     If not the end of the slots, this refers to an entry
+     *     which has just grown.
+     */
+    void Trim(SlotRef grown) {
+        std::list< SlotRef > candidates;
+        if (
+            (policy == EvictionPolicy::WTinyLfu)
+            && (grown != slots.end())
+            && !grown->second.inWindow
+        ) {
+            grown->second.isCandidate = true;
+            candidates.push_back(grown);
+        }
+        while (
+            (windowBytes > windowCapacity)
+            && !window.empty()
+        ) {
+            const auto slot = slots.find(window.back());
+            slot->second.inWindow = false;
+            slot->second.isCandidate = true;
+            windowBytes -= slot->second.cost;
+            recency.splice(recency.begin(), window, slot->second.recency);
+            candidates.push_back(slot);
+        }
+        while (residentBytes > capacity) {
+            const auto victim = FindVictim();
+            if (candidates.empty()) {
+                if (victim == slots.end()) {
+                    break;
+                }
+                Erase(victim);
+                ++statistics.evictions;
+            } else if (
+                (victim == slots.end())
+                || (
+                    sketch->Estimate(candidates.front()->first)
+                    <= sketch->Estimate(victim->first)
+                )
+            ) {
+                Erase(candidates.front());
+                candidates.pop_front();
+                ++statistics.rejections;
+            } else {
+                Erase(victim);
+                ++statistics.evictions;
+            }
+        }
+        for (auto& candidate: candidates) {
+            candidate->second.isCandidate = false;
+        }
+    }
+};
+
+ContentCache::~ContentCache() noexcept = default;
+
+ContentCache::ContentCache(
+    size_t capacity,
+    EvictionPolicy policy
+)
+    : impl_(new Impl())
+{
+    impl_->capacity = capacity;
+    impl_->policy = policy;
+    if (policy == EvictionPolicy::WTinyLfu) {
+        impl_->windowCapacity = (size_t)((double)capacity * WINDOW_FRACTION);
+        impl_->sketch.reset(
+            new FrequencySketch(
+                std::max(capacity / TYPICAL_ENTRY_COST, (size_t)1)
+            )
+        );
+    } else {
+        impl_->windowCapacity = 0;
+    }
+}
+
+auto ContentCache::Lookup(
+    const std::string& path,
+    const FileInfo& fileInfo
+) -> std::shared_ptr< const Entry > {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    impl_->RecordLookup(path);
+    const auto slot = impl_->slots.find(path);
+    if (slot == impl_->slots.end()) {
+        ++impl_->statistics.misses;
+        return nullptr;
+    }
+    if (!slot->second.entry->fileInfo.IsSameVersionAs(fileInfo)) {
+        impl_->Erase(slot);
+        ++impl_->statistics.misses;
+        return nullptr;
+    }
+    impl_->Touch(slot);
+    ++impl_->statistics.hits;
+    return slot->second.entry;
+}
+
+bool ContentCache::Insert(std::shared_ptr< const Entry > entry) {
+    const auto cost = ComputeCost(*entry);
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    const auto existing = impl_->slots.find(entry->path);
+    if (existing != impl_->slots.end()) {
+        impl_->Erase(existing);
+    }
+    if (cost > impl_->capacity) {
+        return false;
+    }
+    const auto inWindow = (impl_->policy == EvictionPolicy::WTinyLfu);
+    auto& list = (inWindow ? impl_->window : impl_->recency);
+    list.push_front(entry->path);
+    const auto slot = impl_->slots.insert({entry->path, Impl::Slot()}).first;
+    slot->second.entry = entry;
+    slot->second.recency = list.begin();
+    slot->second.inWindow = inWindow;
+    impl_->Charge(slot, cost);
+    impl_->Trim(impl_->slots.end());
+    return (impl_->slots.find(entry->path) != impl_->slots.end());
+}
+
+std::shared_ptr< const std::string > ContentCache::LookupVariant(
+    const std::string& path,
+    const FileInfo& fileInfo,
+    const std::string& coding
+) {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    const auto slot = impl_->slots.find(path);
+    if (
+        (slot == impl_->slots.end())
+        || !slot->second.entry->fileInfo.IsSameVersionAs(fileInfo)
+    ) {
+        return nullptr;
+    }
+    const auto variant = slot->second.variants.find(coding);
+    if (variant == slot->second.variants.end()) {
+        return nullptr;
+    }
+    return variant->second;
+}
+
+bool ContentCache::InsertVariant(
+    const std::string& path,
+    const FileInfo& fileInfo,
+    const std::string& coding,
+    std::shared_ptr< const std::string > variant
+) {
+    const auto cost = ENTRY_OVERHEAD + coding.length() + variant->length();
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    const auto slot = impl_->slots.find(path);
+    if (
+        (slot == impl_->slots.end())
+        || !slot->second.entry->fileInfo.IsSameVersionAs(fileInfo)
+        || (slot->second.variants.find(coding) != slot->second.variants.end())
+        || (slot->second.cost + cost > impl_->capacity)
+    ) {
+        return false;
+    }
+    slot->second.variants[coding] = variant;
+    impl_->Charge(slot, cost);
+    impl_->Trim(slot);
+    return (impl_->slots.find(path) != impl_->slots.end());
+}
+
+bool ContentCache::ReplaceVariant(
+    const std::string& path,
+    const FileInfo& fileInfo,
+    const std::string& coding,
+    std::shared_ptr< const std::string > oldVariant,
+    std::shared_ptr< const std::string > newVariant
+) {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    const auto slot = impl_->slots.find(path);
+    if (
+        (slot == impl_->slots.end())
+        || !slot->second.entry->fileInfo.IsSameVersionAs(fileInfo)
+    ) {
+        return false;
+    }
+    const auto variant = slot->second.variants.find(coding);
+    if (
+        (variant == slot->second.variants.end())
+        || (variant->second != oldVariant)
+        || (slot->second.cost - oldVariant->length() + newVariant->length() > impl_->capacity)
+    ) {
+        return false;
+    }
+
+    // The template of the response serving the old variant has to go
+    // along with it, since its header block gives the old length.
+    const auto response = slot->second.responses.find(coding);
+    if (response != slot->second.responses.end()) {
+        impl_->Discharge(slot, ComputeResponseCost(coding, *response->second));
+        (void)slot->second.responses.erase(response);
+    }
+    impl_->Discharge(slot, oldVariant->length());
+    variant->second = newVariant;
+    impl_->Charge(slot, newVariant->length());
+    if (newVariant->length() > oldVariant->length()) {
+        impl_->Trim(slot);
+    }
+    return (impl_->slots.find(path) != impl_->slots.end());
+}
+
+std::shared_ptr< const Http::Response > ContentCache::LookupResponse(
+    const std::string& path,
+    const FileInfo& fileInfo,
+    const std::string& coding
+) {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    const auto slot = impl_->slots.find(path);
+    if (
+        (slot == impl_->slots.end())
+        || !slot->second.entry->fileInfo.IsSameVersionAs(fileInfo)
+    ) {
+        return nullptr;
+    }
+    const auto response = slot->second.responses.find(coding);
+    if (response == slot->second.responses.end()) {
+        return nullptr;
+    }
+    return response->second;
+}
+
+bool ContentCache::InsertResponse(
+    const std::string& path,
+    const FileInfo& fileInfo,
+    const std::string& coding,
+    std::shared_ptr< const Http::Response > response
+) {
+    const auto cost = ComputeResponseCost(coding, *response);
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    const auto slot = impl_->slots.find(path);
+    if (
+        (slot == impl_->slots.end())
+        || !slot->second.entry->fileInfo.IsSameVersionAs(fileInfo)
+        || (slot->second.responses.find(coding) != slot->second.responses.end())
+        || (slot->second.cost + cost > impl_->capacity)
+    ) {
+        return false;
+    }
+    slot->second.responses[coding] = response;
+    impl_->Charge(slot, cost);
+    impl_->Trim(slot);
+    return (impl_->slots.find(path) != impl_->slots.end());
+}
+
+void ContentCache::Remove(const std::string& path) {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    const auto slot = impl_->slots.find(path);
+    if (slot != impl_->slots.end()) {
+        impl_->Erase(slot);
+    }
+}
+
+void ContentCache::Clear() {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    impl_->slots.clear();
+    impl_->recency.clear();
+    impl_->window.clear();
+    impl_->residentBytes = 0;
+    impl_->windowBytes = 0;
+    ++impl_->generation;
+}
+
+uint64_t ContentCache::GetGeneration() const {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    return impl_->generation;
+}
+
+void ContentCache::MarkCurrent(
+    const std::string& path,
+    const FileInfo& fileInfo,
+    uint64_t generation
+) {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    if (generation != impl_->generation) {
+        return;
+    }
+    const auto slot = impl_->slots.find(path);
+    if (
+        (slot != impl_->slots.end())
+        && slot->second.entry->fileInfo.IsSameVersionAs(fileInfo)
+    ) {
+        slot->second.isCurrent = true;
+    }
+}
+
+auto ContentCache::LookupCurrent(
+    const std::string& path
+) -> std::shared_ptr< const Entry > {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    const auto slot = impl_->slots.find(path);
+    if (
+        (slot == impl_->slots.end())
+        || !slot->second.isCurrent
+    ) {
+        return nullptr;
+    }
+    impl_->RecordLookup(path);
+    impl_->Touch(slot);
+    ++impl_->statistics.hits;
+    return slot->second.entry;
+}
+
+size_t ContentCache::GetCapacity() const {
+    return impl_->capacity;
+}
+
+size_t ContentCache::GetResidentBytes() const {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    return impl_->residentBytes;
+}
+
+auto ContentCache::GetStatistics() const -> Statistics {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    auto statistics = impl_->statistics;
+    statistics.entries = impl_->slots.size();
+    statistics.residentBytes = impl_->residentBytes;
+    statistics.capacity = impl_->capacity;
+    return statistics;
+}
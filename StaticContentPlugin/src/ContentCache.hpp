@@ -0,0 +1,492 @@
+#ifndef STATIC_CONTENT_PLUGIN_CONTENT_CACHE_HPP
+#define STATIC_CONTENT_PLUGIN_CONTENT_CACHE_HPP
+
+/**
+ * @file ContentCache.hpp
+ *
+ * This module declares the ContentCache class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "FileInfo.hpp"
+
+#include <Http/Response.hpp>
+#include <map>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class FileMapping;
+
+/**
+ * This class holds the contents of recently served files in memory,
+ * along with information derived from them, such as entity tags and
+ * content types, so that they don't need to be read from the file system
+ * or recomputed each time the files are served.
+ *
+ * Encoded (e.g. compressed) variants of file contents are cached along
+ * with the entries of the files from which they were made, and are
+ * discarded along with them.  So are templates of the responses used
+ * to serve the files, which hold the header blocks of the responses,
+ * since these are the same every time a file is served in full.
+ *
+ * The total number of bytes held by the cache is bounded.  When room is
+ * needed for a new entry, entries are evicted according to the cache's
+ * eviction policy: either simply the least recently used entries, or
+ * (with W-TinyLFU) entries chosen so that a burst of requests for files
+ * which are rarely requested, such as a crawler walking the whole tree,
+ * doesn't push out files which are requested often.
+ *
+ * The cache counts its hits, misses and evictions, so that its capacity
+ * can be tuned.
+ */
+class ContentCache {
+    // Types
+public:
+    /**
+     * These are the policies which may be used to choose entries
+     * to evict from the cache when room is needed.
+     */
+    enum class EvictionPolicy {
+        /**
+         * Evict the least recently used entries.
+         */
+        Lru,
+
+        /**
+         * New entries are placed in a small "window" which is managed by
+         * recency.  Entries pushed out of the window are only admitted to
+         * the rest of the cache if they have been looked up more often
+         * recently than the least recently used entries they would
+         * replace, as estimated by a frequency sketch.
+         */
+        WTinyLfu,
+    };
+
+    /**
+     * This holds counters and other figures describing
+     * how well the cache is working.
+     */
+    struct Statistics {
+        /**
+         * This is the number of lookups which found an entry.
+         */
+        uint64_t hits = 0;
+
+        /**
+         * This is the number of lookups which didn't find an entry.
+         */
+        uint64_t misses = 0;
+
+        /**
+         * This is the number of entries evicted to make room
+         * for other entries.
+         */
+        uint64_t evictions = 0;
+
+        /**
+         * This is the number of entries turned away, with the W-TinyLFU
+         * policy, because they weren't popular enough to replace
+         * other entries.
+         */
+        uint64_t rejections = 0;
+
+        /**
+         * This is the number of entries in the cache.
+         */
+        size_t entries = 0;
+
+        /**
+         * This is the number of bytes currently held by the cache.
+         */
+        size_t residentBytes = 0;
+
+        /**
+         * This is the maximum number of bytes the cache may hold.
+         */
+        size_t capacity = 0;
+    };
+
+    /**
+     * This holds everything the cache knows about one version of one file.
+     * Entries are immutable once they are placed in the cache, so they
+     * may be shared freely between concurrent requests.
+     */
+    struct Entry {
+        /**
+         * This is the file system path of the file.
+         */
+        std::string path;
+
+        /**
+         * This is the metadata of the version of the file
+         * described by the entry.
+         */
+        FileInfo fileInfo;
+
+        /**
+         * This holds the contents of the file.
+         */
+        std::shared_ptr< const std::string > content;
+
+        /**
+         * This is a read-only memory mapping of the file, used instead of
+         * holding the contents of the file, if the file is mapped.
+         * Mapped contents live in the operating system's page cache,
+         * so they aren't charged against the capacity of the cache.
+         */
+        std::shared_ptr< const FileMapping > mapping;
+
+        /**
+         * This is the entity tag computed for the file.
+         */
+        std::string entityTag;
+
+        /**
+         * This is the value to use for the Content-Type header
+         * when serving the file.
+         */
+        std::string contentType;
+
+        /**
+         * This indicates whether or not the file is of a type
+         * which benefits from being compressed.
+         */
+        bool isWorthyOfBeingGzipped = false;
+
+        /**
+         * This holds the metadata of any precompressed "sidecar" files
+         * found next to the file, keyed by content coding.
+         */
+        std::map< std::string, FileInfo > sidecars;
+
+        /**
+         * This holds any precompressed variants of the file which are
+         * mapped into memory along with it, keyed by content coding.
+         * This is used for files served from archives.
+         */
+        std::map< std::string, std::shared_ptr< const FileMapping > > encodings;
+    };
+
+    // Lifecycle Methods
+public:
+    ~ContentCache() noexcept;
+    ContentCache(const ContentCache&) = delete;
+    ContentCache(ContentCache&&) noexcept = delete;
+    ContentCache& operator=(const ContentCache&) = delete;
+    ContentCache& operator=(ContentCache&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     *
+     * @param[in] capacity
+     *     This is the maximum number of bytes the cache may hold.
+     *     If zero, the cache holds nothing.
+     *
+     * @param[in] policy
+     *     This is the policy to use to choose entries to evict
+     *     when room is needed.
+     */
+    explicit ContentCache(
+        size_t capacity,
+        EvictionPolicy policy = EvictionPolicy::Lru
+    );
+
+    /**
+     * This method looks up the cache entry for the given file.  The entry
+     * is only returned if it describes the same version of the file as
+     * the given metadata.  Otherwise any stale entry is discarded.
+     *
+     * @param[in] path
+     *     This is the file system path of the file to look up.
+     *
+     * @param[in] fileInfo
+     *     This is the current metadata of the file.
+     *
+     * @return
+     *     The cache entry for the file is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the file is not in the cache, or if the
+     *     version of it in the cache is out of date.
+     */
+    std::shared_ptr< const Entry > Lookup(
+        const std::string& path,
+        const FileInfo& fileInfo
+    );
+
+    /**
+     * This method adds the given entry to the cache, replacing any
+     * entry already there for the same file, and evicting other entries
+     * as necessary to make room.
+     *
+     * @param[in] entry
+     *     This is the entry to add to the cache.
+     *
+     * @return
+     *     An indication of whether or not the entry was added
+     *     is returned.  Entries larger than the capacity of the
+     *     cache are not added, nor are entries turned away by
+     *     the eviction policy.
+     */
+    bool Insert(std::shared_ptr< const Entry > entry);
+
+    /**
+     * This method looks up an encoded variant of the contents of the
+     * given version of the given file.
+     *
+     * @param[in] path
+     *     This is the file system path of the file to look up.
+     *
+     * @param[in] fileInfo
+     *     This is the current metadata of the file.
+     *
+     * @param[in] coding
+     *     This is the name of the content coding of the variant.
+     *
+     * @return
+     *     The variant is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the variant is not in the cache.
+     */
+    std::shared_ptr< const std::string > LookupVariant(
+        const std::string& path,
+        const FileInfo& fileInfo,
+        const std::string& coding
+    );
+
+    /**
+     * This method adds an encoded variant of the contents of the given
+     * version of the given file to the cache.  The variant is only added
+     * if the cache holds an entry for the same version of the file.
+     * Other entries are evicted as necessary to make room.
+     *
+     * @param[in] path
+     *     This is the file system path of the file.
+     *
+     * @param[in] fileInfo
+     *     This is the metadata of the version of the file
+     *     from which the variant was made.
+     *
+     * @param[in] coding
+     *     This is the name of the content coding of the variant.
+     *
+     * @param[in] variant
+     *     This is the variant to add.
+     *
+     * @return
+     *     An indication of whether or not the variant was added
+     *     is returned.
+     */
+    bool InsertVariant(
+        const std::string& path,
+        const FileInfo& fileInfo,
+        const std::string& coding,
+        std::shared_ptr< const std::string > variant
+    );
+
+    /**
+     * This method replaces an encoded variant of the contents of the given
+     * version of the given file, held in the cache, with another one,
+     * such as one compressed more tightly.  The variant is only replaced
+     * if it's still the one expected.  Any template of the response
+     * serving the old variant is discarded along with it.
+     *
+     * @param[in] path
+     *     This is the file system path of the file.
+     *
+     * @param[in] fileInfo
+     *     This is the metadata of the version of the file
+     *     from which the variants were made.
+     *
+     * @param[in] coding
+     *     This is the name of the content coding of the variants.
+     *
+     * @param[in] oldVariant
+     *     This is the variant expected to be in the cache.
+     *
+     * @param[in] newVariant
+     *     This is the variant with which to replace it.
+     *
+     * @return
+     *     An indication of whether or not the variant was replaced
+     *     is returned.
+     */
+    bool ReplaceVariant(
+        const std::string& path,
+        const FileInfo& fileInfo,
+        const std::string& coding,
+        std::shared_ptr< const std::string > oldVariant,
+        std::shared_ptr< const std::string > newVariant
+    );
+
+    /**
+     * This method looks up the template of the response used to serve
+     * the given version of the given file, in full, with the given
+     * content coding.
+     *
+     * @param[in] path
+     *     This is the file system path of the file to look up.
+     *
+     * @param[in] fileInfo
+     *     This is the current metadata of the file.
+     *
+     * @param[in] coding
+     *     This is the name of the content coding of the response,
+     *     or an empty string if the file isn't encoded.
+     *
+     * @return
+     *     The template of the response is returned.  It holds the
+     *     status and header block of the response, but not the body.
+     *
+     * @retval nullptr
+     *     This is returned if the template is not in the cache.
+     */
+    std::shared_ptr< const Http::Response > LookupResponse(
+        const std::string& path,
+        const FileInfo& fileInfo,
+        const std::string& coding
+    );
+
+    /**
+     * This method adds the template of the response used to serve the
+     * given version of the given file, in full, with the given content
+     * coding, to the cache.  The template is only added if the cache
+     * holds an entry for the same version of the file.  Other entries
+     * are evicted as necessary to make room.
+     *
+     * @param[in] path
+     *     This is the file system path of the file.
+     *
+     * @param[in] fileInfo
+     *     This is the metadata of the version of the file
+     *     which the response serves.
+     *
+     * @param[in] coding
+     *     This is the name of the content coding of the response,
+     *     or an empty string if the file isn't encoded.
+     *
+     * @param[in] response
+     *     This is the template to add.  It should hold the status and
+     *     header block of the response, but not the body.
+     *
+     * @return
+     *     An indication of whether or not the template was added
+     *     is returned.
+     */
+    bool InsertResponse(
+        const std::string& path,
+        const FileInfo& fileInfo,
+        const std::string& coding,
+        std::shared_ptr< const Http::Response > response
+    );
+
+    /**
+     * This method removes any entry for the given file from the cache.
+     *
+     * @param[in] path
+     *     This is the file system path of the file to remove.
+     */
+    void Remove(const std::string& path);
+
+    /**
+     * This method removes all entries from the cache, and begins
+     * a new generation of the cache.
+     */
+    void Clear();
+
+    /**
+     * This method returns the current generation of the cache, which
+     * changes every time the cache is cleared.
+     *
+     * @return
+     *     The current generation of the cache is returned.
+     */
+    uint64_t GetGeneration() const;
+
+    /**
+     * This method marks the entry for the given file as being known to
+     * be current, so that it may be looked up with LookupCurrent until
+     * the cache is cleared.  Nothing is marked if the cache has been
+     * cleared since the given generation, or if the entry isn't for
+     * the given version of the file.
+     *
+     * @param[in] path
+     *     This is the file system path of the file.
+     *
+     * @param[in] fileInfo
+     *     This is the metadata of the file, looked up during
+     *     the given generation of the cache.
+     *
+     * @param[in] generation
+     *     This is the generation of the cache at the time the metadata
+     *     of the file was looked up.
+     */
+    void MarkCurrent(
+        const std::string& path,
+        const FileInfo& fileInfo,
+        uint64_t generation
+    );
+
+    /**
+     * This method looks up the entry for the given file, without
+     * validating it against the metadata of the file.  Only entries
+     * marked as current since the cache was last cleared are returned.
+     * This is meant to be used only when something else clears the
+     * cache whenever files change.
+     *
+     * @param[in] path
+     *     This is the file system path of the file to look up.
+     *
+     * @return
+     *     The entry for the file is returned, if it's in the cache and
+     *     marked as current.  Otherwise, nullptr is returned.
+     */
+    std::shared_ptr< const Entry > LookupCurrent(const std::string& path);
+
+    /**
+     * This method returns the maximum number of bytes the cache may hold.
+     *
+     * @return
+     *     The maximum number of bytes the cache may hold is returned.
+     */
+    size_t GetCapacity() const;
+
+    /**
+     * This method returns the number of bytes currently held by the cache.
+     *
+     * @return
+     *     The number of bytes currently held by the cache is returned.
+     */
+    size_t GetResidentBytes() const;
+
+    /**
+     * This method returns the counters and other figures describing
+     * how well the cache is working.
+     *
+     * @return
+     *     The statistics of the cache are returned.
+     */
+    Statistics GetStatistics() const;
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* STATIC_CONTENT_PLUGIN_CONTENT_CACHE_HPP */
@@ -0,0 +1,134 @@
+/**
+ * @file ContentStore.cpp
+ *
+ * This module contains the implementation of the ContentStore class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "ContentStore.hpp"
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * This contains the private properties of the ContentStore class.
+ */
+struct ContentStore::Impl {
+    // Types
+
+    /**
+     * This is the type used to hold all the contents in memory
+     * which have the same hash.
+     */
+    typedef std::vector< std::weak_ptr< const std::string > > Bucket;
+
+    // Properties
+
+    /**
+     * This is used to synchronize access to the store.
+     */
+    mutable std::mutex mutex;
+
+    /**
+     * These are the contents in memory, keyed by hash.
+     */
+    std::unordered_map< size_t, Bucket > buckets;
+
+    /**
+     * This is the number of contents remembered since the store
+     * was last swept for contents which are no longer in memory.
+     */
+    size_t addedSinceSweep = 0;
+
+    /**
+     * This holds the counters of how well the store is working.
+     */
+    Statistics statistics;
+
+    // Methods
+
+    /**
+     * This method forgets all contents which are no longer in memory.
+     */
+    void Sweep() {
+        for (auto bucket = buckets.begin(); bucket != buckets.end(); ) {
+            auto& contents = bucket->second;
+            for (size_t i = 0; i < contents.size(); ) {
+                if (contents[i].expired()) {
+                    contents[i] = contents.back();
+                    contents.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+            if (contents.empty()) {
+                bucket = buckets.erase(bucket);
+            } else {
+                ++bucket;
+            }
+        }
+        addedSinceSweep = 0;
+    }
+};
+
+ContentStore::~ContentStore() noexcept = default;
+
+ContentStore::ContentStore()
+    : impl_(new Impl())
+{
+}
+
+std::shared_ptr< const std::string > ContentStore::Intern(
+    std::shared_ptr< const std::string > content
+) {
+    const auto hash = std::hash< std::string >()(*content);
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    auto& bucket = impl_->buckets[hash];
+    for (size_t i = 0; i < bucket.size(); ) {
+        const auto existing = bucket[i].lock();
+        if (existing == nullptr) {
+            bucket[i] = bucket.back();
+            bucket.pop_back();
+            continue;
+        }
+        if (
+            (existing == content)
+            || (*existing == *content)
+        ) {
+            if (existing != content) {
+                ++impl_->statistics.duplicates;
+                impl_->statistics.duplicateBytes += content->length();
+            }
+            return existing;
+        }
+        ++i;
+    }
+    bucket.push_back(content);
+
+    // Every so often, forget contents which are no longer in memory,
+    // so that the store doesn't grow without bound.  Sweeping once the
+    // number of contents added matches the number of buckets keeps the
+    // cost of sweeping proportional to the number of contents added.
+    if (++impl_->addedSinceSweep > impl_->buckets.size()) {
+        impl_->Sweep();
+    }
+    return content;
+}
+
+auto ContentStore::GetStatistics() const -> Statistics {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    auto statistics = impl_->statistics;
+    for (const auto& bucket: impl_->buckets) {
+        for (const auto& content: bucket.second) {
+            const auto existing = content.lock();
+            if (existing != nullptr) {
+                ++statistics.contents;
+                statistics.bytes += existing->length();
+            }
+        }
+    }
+    return statistics;
+}
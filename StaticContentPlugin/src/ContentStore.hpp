@@ -0,0 +1,113 @@
+#ifndef STATIC_CONTENT_PLUGIN_CONTENT_STORE_HPP
+#define STATIC_CONTENT_PLUGIN_CONTENT_STORE_HPP
+
+/**
+ * @file ContentStore.hpp
+ *
+ * This module declares the ContentStore class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * This class keeps track of the file contents (and encoded variants of
+ * file contents) held in memory, by their contents, so that identical
+ * contents read from different files, possibly in different spaces,
+ * are held in memory only once.
+ *
+ * The store doesn't keep anything alive by itself; contents are held
+ * by the caches which use them, and are forgotten by the store once
+ * nothing else holds them.
+ */
+class ContentStore {
+    // Types
+public:
+    /**
+     * This holds counters and other figures describing
+     * how well the store is working.
+     */
+    struct Statistics {
+        /**
+         * This is the number of distinct contents in memory.
+         */
+        size_t contents = 0;
+
+        /**
+         * This is the total number of bytes of the distinct
+         * contents in memory.
+         */
+        size_t bytes = 0;
+
+        /**
+         * This is the number of times contents were found to be
+         * identical to contents already in memory.
+         */
+        uint64_t duplicates = 0;
+
+        /**
+         * This is the total number of bytes of the contents found
+         * to be identical to contents already in memory.
+         */
+        uint64_t duplicateBytes = 0;
+    };
+
+    // Lifecycle Methods
+public:
+    ~ContentStore() noexcept;
+    ContentStore(const ContentStore&) = delete;
+    ContentStore(ContentStore&&) noexcept = delete;
+    ContentStore& operator=(const ContentStore&) = delete;
+    ContentStore& operator=(ContentStore&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     */
+    ContentStore();
+
+    /**
+     * This method returns the copy of the given contents already in
+     * memory, if there is one.  Otherwise, the given contents are
+     * remembered, and returned.
+     *
+     * @param[in] content
+     *     These are the contents to look up.
+     *
+     * @return
+     *     The copy of the contents to use is returned.
+     */
+    std::shared_ptr< const std::string > Intern(
+        std::shared_ptr< const std::string > content
+    );
+
+    /**
+     * This method returns the counters and other figures describing
+     * how well the store is working.
+     *
+     * @return
+     *     The statistics of the store are returned.
+     */
+    Statistics GetStatistics() const;
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* STATIC_CONTENT_PLUGIN_CONTENT_STORE_HPP */
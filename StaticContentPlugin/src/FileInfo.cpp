@@ -0,0 +1,53 @@
+/**
+ * @file FileInfo.cpp
+ *
+ * This module contains the implementation of the GetFileInfo function.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "FileInfo.hpp"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+bool FileInfo::IsSameVersionAs(const FileInfo& other) const {
+    return (
+        (isExisting == other.isExisting)
+        && (isDirectory == other.isDirectory)
+        && (size == other.size)
+        && (lastModifiedTime == other.lastModifiedTime)
+        && (lastModifiedTimeNanoseconds == other.lastModifiedTimeNanoseconds)
+        && (inode == other.inode)
+    );
+}
+
+bool GetFileInfo(
+    const std::string& path,
+    FileInfo& info
+) {
+    info = FileInfo();
+#ifdef _WIN32
+    struct _stat64 s;
+    if (_stat64(path.c_str(), &s) != 0) {
+        return false;
+    }
+    info.isDirectory = ((s.st_mode & _S_IFDIR) != 0);
+#else /* POSIX */
+    struct stat s;
+    if (stat(path.c_str(), &s) != 0) {
+        return false;
+    }
+    info.isDirectory = S_ISDIR(s.st_mode);
+    info.inode = (uint64_t)s.st_ino;
+#endif /* _WIN32 / POSIX */
+    info.isExisting = true;
+    info.size = (uint64_t)s.st_size;
+    info.lastModifiedTime = (int64_t)s.st_mtime;
+#if defined(__linux__)
+    info.lastModifiedTimeNanoseconds = (uint32_t)s.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+    info.lastModifiedTimeNanoseconds = (uint32_t)s.st_mtimespec.tv_nsec;
+#endif
+    return true;
+}
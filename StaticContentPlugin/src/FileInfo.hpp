@@ -0,0 +1,91 @@
+#ifndef STATIC_CONTENT_PLUGIN_FILE_INFO_HPP
+#define STATIC_CONTENT_PLUGIN_FILE_INFO_HPP
+
+/**
+ * @file FileInfo.hpp
+ *
+ * This module declares the FileInfo structure and the function
+ * used to fill it in.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * This holds the metadata of a file which matters when deciding
+ * whether or not any previously cached information about the file
+ * is still valid.
+ */
+struct FileInfo {
+    /**
+     * This indicates whether or not the file exists.
+     */
+    bool isExisting = false;
+
+    /**
+     * This indicates whether or not the file is a directory.
+     */
+    bool isDirectory = false;
+
+    /**
+     * This is the size of the file, in bytes.
+     */
+    uint64_t size = 0;
+
+    /**
+     * This is the time the file was last modified, in seconds
+     * since the UNIX epoch.
+     */
+    int64_t lastModifiedTime = 0;
+
+    /**
+     * This is the sub-second part of the time the file was last modified,
+     * in nanoseconds, on platforms which provide it.  Otherwise it's zero.
+     */
+    uint32_t lastModifiedTimeNanoseconds = 0;
+
+    /**
+     * This is the serial number of the file within its file system,
+     * on platforms which provide one.  Otherwise it's zero.
+     */
+    uint64_t inode = 0;
+
+    // Methods
+
+    /**
+     * This method determines whether or not the file described by the
+     * given information is the same version of the file described by
+     * this information.
+     *
+     * @param[in] other
+     *     This is the other file information to compare with this one.
+     *
+     * @return
+     *     An indication of whether or not the two pieces of information
+     *     describe the same version of the file is returned.
+     */
+    bool IsSameVersionAs(const FileInfo& other) const;
+};
+
+/**
+ * This function looks up the metadata of the file at the given path,
+ * using a single query of the file system.
+ *
+ * @param[in] path
+ *     This is the path of the file to look up.
+ *
+ * @param[out] info
+ *     This is where to store the file's metadata.
+ *
+ * @return
+ *     An indication of whether or not the file exists
+ *     is returned.
+ */
+bool GetFileInfo(
+    const std::string& path,
+    FileInfo& info
+);
+
+#endif /* STATIC_CONTENT_PLUGIN_FILE_INFO_HPP */
@@ -0,0 +1,197 @@
+/**
+ * @file FileMapping.cpp
+ *
+ * This module contains the implementation of the FileMapping class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "FileMapping.hpp"
+
+#include <atomic>
+#include <StringExtensions/StringExtensions.hpp>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else /* POSIX */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif /* _WIN32 / POSIX */
+
+namespace {
+
+    /**
+     * This is the number of files currently mapped.
+     */
+    std::atomic< size_t > activeMappings(0);
+
+    /**
+     * This is the total number of bytes currently mapped.
+     */
+    std::atomic< size_t > mappedBytes(0);
+
+}
+
+/**
+ * This contains the private properties of the FileMapping class.
+ */
+struct FileMapping::Impl {
+    /**
+     * This is the path of the mapped file.
+     */
+    std::string path;
+
+    /**
+     * This points to the mapped contents of the file.
+     */
+    const char* data = nullptr;
+
+    /**
+     * This is the number of bytes mapped.
+     */
+    size_t size = 0;
+
+    /**
+     * This is the function to call to publish any diagnostic messages.
+     */
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate;
+
+    /**
+     * If this is a view of part of another mapping, this is
+     * the other mapping, which is kept alive by the view.
+     */
+    std::shared_ptr< const FileMapping > whole;
+};
+
+FileMapping::~FileMapping() noexcept {
+    if (
+        (impl_->data == nullptr)
+        || (impl_->whole != nullptr)
+    ) {
+        return;
+    }
+#ifdef _WIN32
+    (void)UnmapViewOfFile(impl_->data);
+#else /* POSIX */
+    (void)munmap((void*)impl_->data, impl_->size);
+#endif /* _WIN32 / POSIX */
+    const auto remainingMappings = --activeMappings;
+    const auto remainingBytes = (mappedBytes -= impl_->size);
+    impl_->diagnosticMessageDelegate(
+        "FileMapping",
+        0,
+        StringExtensions::sprintf(
+            "unmapped '%s' (%zu bytes); %zu mappings (%zu bytes) remain",
+            impl_->path.c_str(),
+            impl_->size,
+            remainingMappings,
+            remainingBytes
+        )
+    );
+}
+
+FileMapping::FileMapping()
+    : impl_(new Impl())
+{
+}
+
+std::shared_ptr< const FileMapping > FileMapping::Map(
+    const std::string& path,
+    size_t size,
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
+) {
+    if (size == 0) {
+        return nullptr;
+    }
+#ifdef _WIN32
+    const auto file = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    const auto mappingObject = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    (void)CloseHandle(file);
+    if (mappingObject == NULL) {
+        return nullptr;
+    }
+    const auto data = MapViewOfFile(mappingObject, FILE_MAP_READ, 0, 0, size);
+    (void)CloseHandle(mappingObject);
+    if (data == NULL) {
+        return nullptr;
+    }
+#else /* POSIX */
+    const auto file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return nullptr;
+    }
+    const auto data = mmap(NULL, size, PROT_READ, MAP_SHARED, file, 0);
+    (void)close(file);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+#endif /* _WIN32 / POSIX */
+    std::shared_ptr< FileMapping > mapping(new FileMapping());
+    mapping->impl_->path = path;
+    mapping->impl_->data = (const char*)data;
+    mapping->impl_->size = size;
+    mapping->impl_->diagnosticMessageDelegate = diagnosticMessageDelegate;
+    const auto totalMappings = ++activeMappings;
+    const auto totalBytes = (mappedBytes += size);
+    diagnosticMessageDelegate(
+        "FileMapping",
+        0,
+        StringExtensions::sprintf(
+            "mapped '%s' (%zu bytes); %zu mappings (%zu bytes) total",
+            path.c_str(),
+            size,
+            totalMappings,
+            totalBytes
+        )
+    );
+    return mapping;
+}
+
+std::shared_ptr< const FileMapping > FileMapping::Slice(
+    const std::shared_ptr< const FileMapping >& mapping,
+    uint64_t offset,
+    uint64_t size
+) {
+    if (
+        (size == 0)
+        || (offset > mapping->impl_->size)
+        || (size > mapping->impl_->size - offset)
+    ) {
+        return nullptr;
+    }
+    std::shared_ptr< FileMapping > slice(new FileMapping());
+    slice->impl_->path = mapping->impl_->path;
+    slice->impl_->data = mapping->impl_->data + offset;
+    slice->impl_->size = (size_t)size;
+    slice->impl_->whole = mapping;
+    return slice;
+}
+
+size_t FileMapping::GetActiveMappings() {
+    return activeMappings;
+}
+
+size_t FileMapping::GetMappedBytes() {
+    return mappedBytes;
+}
+
+const char* FileMapping::GetData() const {
+    return impl_->data;
+}
+
+size_t FileMapping::GetSize() const {
+    return impl_->size;
+}
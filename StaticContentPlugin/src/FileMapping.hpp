@@ -0,0 +1,148 @@
+#ifndef STATIC_CONTENT_PLUGIN_FILE_MAPPING_HPP
+#define STATIC_CONTENT_PLUGIN_FILE_MAPPING_HPP
+
+/**
+ * @file FileMapping.hpp
+ *
+ * This module declares the FileMapping class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <SystemAbstractions/DiagnosticsSender.hpp>
+
+/**
+ * This class maps the contents of a file into memory, read-only.
+ * The mapping is shared by holding the object in a std::shared_ptr,
+ * and the file is unmapped when the last reference is released.
+ *
+ * Because the mapped memory is backed directly by the operating system's
+ * page cache, there is only ever one copy of the file contents in memory,
+ * no matter how many requests are serving it at once.
+ *
+ * @note
+ *     Files must be replaced (e.g. renamed over) rather than truncated
+ *     in place while they are mapped, since accessing mapped pages past
+ *     the end of a truncated file is fatal on most platforms.
+ */
+class FileMapping {
+    // Lifecycle Methods
+public:
+    ~FileMapping() noexcept;
+    FileMapping(const FileMapping&) = delete;
+    FileMapping(FileMapping&&) noexcept = delete;
+    FileMapping& operator=(const FileMapping&) = delete;
+    FileMapping& operator=(FileMapping&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This function maps the given file into memory.
+     *
+     * @param[in] path
+     *     This is the path of the file to map.
+     *
+     * @param[in] size
+     *     This is the size of the file, in bytes.
+     *
+     * @param[in] diagnosticMessageDelegate
+     *     This is the function to call to publish any diagnostic messages.
+     *
+     * @return
+     *     The mapping of the file is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the file could not be mapped.
+     */
+    static std::shared_ptr< const FileMapping > Map(
+        const std::string& path,
+        size_t size,
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
+    );
+
+    /**
+     * This function returns a view of part of the given mapping, which
+     * keeps the whole mapping alive for as long as the view exists.
+     *
+     * @param[in] mapping
+     *     This is the mapping of which to return part.
+     *
+     * @param[in] offset
+     *     This is the offset of the first byte of the part to return.
+     *
+     * @param[in] size
+     *     This is the number of bytes in the part to return.
+     *
+     * @return
+     *     The view of part of the mapping is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the part is empty or doesn't lie
+     *     entirely within the mapping.
+     */
+    static std::shared_ptr< const FileMapping > Slice(
+        const std::shared_ptr< const FileMapping >& mapping,
+        uint64_t offset,
+        uint64_t size
+    );
+
+    /**
+     * This function returns the number of files currently mapped.
+     *
+     * @return
+     *     The number of files currently mapped is returned.
+     */
+    static size_t GetActiveMappings();
+
+    /**
+     * This function returns the total number of bytes currently mapped.
+     *
+     * @return
+     *     The total number of bytes currently mapped is returned.
+     */
+    static size_t GetMappedBytes();
+
+    /**
+     * This method returns a pointer to the mapped contents of the file.
+     *
+     * @return
+     *     A pointer to the mapped contents of the file is returned.
+     */
+    const char* GetData() const;
+
+    /**
+     * This method returns the number of bytes mapped.
+     *
+     * @return
+     *     The number of bytes mapped is returned.
+     */
+    size_t GetSize() const;
+
+    // Private Methods
+private:
+    /**
+     * This is the constructor of the class.  It's private so that
+     * the Map function must be used to make mappings.
+     */
+    FileMapping();
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* STATIC_CONTENT_PLUGIN_FILE_MAPPING_HPP */
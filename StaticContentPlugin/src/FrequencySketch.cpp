@@ -0,0 +1,167 @@
+/**
+ * @file FrequencySketch.cpp
+ *
+ * This module contains the implementation of the FrequencySketch class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "FrequencySketch.hpp"
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of rows of counters in the sketch.  Each key
+     * has one counter in each row, and its estimated frequency is the
+     * smallest of them.
+     */
+    constexpr size_t ROWS = 4;
+
+    /**
+     * This is the largest value a counter may hold.
+     */
+    constexpr uint8_t MAX_COUNT = 15;
+
+    /**
+     * This is the number of keys recorded, for each counter in a row,
+     * after which all the counters are halved.
+     */
+    constexpr size_t SAMPLES_PER_COUNTER = 10;
+
+    /**
+     * This function computes a hash of the given key,
+     * using the 64-bit FNV-1a algorithm.
+     *
+     * @param[in] key
+     *     This is the key to hash.
+     *
+     * @return
+     *     The hash of the key is returned.
+     */
+    uint64_t HashKey(const std::string& key) {
+        uint64_t hash = 0xcbf29ce484222325;
+        for (const auto c: key) {
+            hash ^= (uint8_t)c;
+            hash *= 0x100000001b3;
+        }
+        return hash;
+    }
+
+    /**
+     * This function mixes the given hash, using the finalizer of the
+     * SplitMix64 generator, to select a counter in the given row.
+     *
+     * @param[in] hash
+     *     This is the hash of the key.
+     *
+     * @param[in] row
+     *     This is the row of the counter to select.
+     *
+     * @return
+     *     The mixed hash is returned.
+     */
+    uint64_t MixHash(
+        uint64_t hash,
+        size_t row
+    ) {
+        hash += (row + 1) * 0x9e3779b97f4a7c15;
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+        return hash ^ (hash >> 31);
+    }
+
+}
+
+/**
+ * This contains the private properties of the FrequencySketch class.
+ */
+struct FrequencySketch::Impl {
+    // Properties
+
+    /**
+     * These are the counters of the sketch, one row after another.
+     */
+    std::vector< uint8_t > counters;
+
+    /**
+     * This is one less than the number of counters in each row,
+     * which is a power of two.
+     */
+    uint64_t mask = 0;
+
+    /**
+     * This is the number of keys recorded since the counters
+     * were last halved.
+     */
+    size_t samples = 0;
+
+    /**
+     * This is the number of keys to record before halving the counters.
+     */
+    size_t sampleLimit = 0;
+
+    // Methods
+
+    /**
+     * This method returns the counter for the given key
+     * in the given row.
+     *
+     * @param[in] hash
+     *     This is the hash of the key.
+     *
+     * @param[in] row
+     *     This is the row of the counter to return.
+     *
+     * @return
+     *     The counter for the key in the given row is returned.
+     */
+    uint8_t& Counter(
+        uint64_t hash,
+        size_t row
+    ) {
+        return counters[row * (size_t)(mask + 1) + (size_t)(MixHash(hash, row) & mask)];
+    }
+};
+
+FrequencySketch::~FrequencySketch() noexcept = default;
+
+FrequencySketch::FrequencySketch(size_t expectedKeys)
+    : impl_(new Impl())
+{
+    uint64_t width = 64;
+    while (width < (uint64_t)expectedKeys) {
+        width <<= 1;
+    }
+    impl_->counters.resize(ROWS * (size_t)width);
+    impl_->mask = width - 1;
+    impl_->sampleLimit = (size_t)width * SAMPLES_PER_COUNTER;
+}
+
+void FrequencySketch::Record(const std::string& key) {
+    const auto hash = HashKey(key);
+    for (size_t row = 0; row < ROWS; ++row) {
+        auto& counter = impl_->Counter(hash, row);
+        if (counter < MAX_COUNT) {
+            ++counter;
+        }
+    }
+    if (++impl_->samples >= impl_->sampleLimit) {
+        for (auto& counter: impl_->counters) {
+            counter >>= 1;
+        }
+        impl_->samples /= 2;
+    }
+}
+
+unsigned int FrequencySketch::Estimate(const std::string& key) const {
+    const auto hash = HashKey(key);
+    unsigned int estimate = MAX_COUNT;
+    for (size_t row = 0; row < ROWS; ++row) {
+        estimate = std::min(estimate, (unsigned int)impl_->Counter(hash, row));
+    }
+    return estimate;
+}
@@ -0,0 +1,81 @@
+#ifndef STATIC_CONTENT_PLUGIN_FREQUENCY_SKETCH_HPP
+#define STATIC_CONTENT_PLUGIN_FREQUENCY_SKETCH_HPP
+
+/**
+ * @file FrequencySketch.hpp
+ *
+ * This module declares the FrequencySketch class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <string>
+
+/**
+ * This class estimates how often each of a set of keys has been seen
+ * recently, using a count-min sketch of small saturating counters, so that
+ * the popularity of any number of keys can be tracked in a fixed amount
+ * of memory.  Estimates may be too high, when keys share counters, but are
+ * never too low.
+ *
+ * Once enough keys have been recorded, all the counters are halved, so
+ * that keys which used to be popular but aren't anymore are forgotten.
+ */
+class FrequencySketch {
+    // Lifecycle Methods
+public:
+    ~FrequencySketch() noexcept;
+    FrequencySketch(const FrequencySketch&) = delete;
+    FrequencySketch(FrequencySketch&&) noexcept = delete;
+    FrequencySketch& operator=(const FrequencySketch&) = delete;
+    FrequencySketch& operator=(FrequencySketch&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     *
+     * @param[in] expectedKeys
+     *     This is the number of distinct keys expected to be of
+     *     interest at any one time, which determines the size
+     *     of the sketch.
+     */
+    explicit FrequencySketch(size_t expectedKeys);
+
+    /**
+     * This method records that the given key was seen.
+     *
+     * @param[in] key
+     *     This is the key which was seen.
+     */
+    void Record(const std::string& key);
+
+    /**
+     * This method estimates how often the given key was seen recently.
+     *
+     * @param[in] key
+     *     This is the key for which to estimate the frequency.
+     *
+     * @return
+     *     The estimated frequency of the key is returned.
+     */
+    unsigned int Estimate(const std::string& key) const;
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* STATIC_CONTENT_PLUGIN_FREQUENCY_SKETCH_HPP */
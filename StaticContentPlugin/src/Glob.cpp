@@ -0,0 +1,180 @@
+/**
+ * @file Glob.cpp
+ *
+ * This module contains the implementation of the function used to
+ * match paths against shell-style wildcard patterns.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "Glob.hpp"
+
+#include <stddef.h>
+
+namespace {
+
+    /**
+     * This function matches the given character against the character
+     * set ("[...]") which begins at the given position in the given
+     * pattern.
+     *
+     * @param[in] pattern
+     *     This is the pattern containing the character set.
+     *
+     * @param[in,out] position
+     *     On input, this is the position of the "[" which begins the
+     *     character set.  On output, this is the position just past
+     *     the "]" which ends the character set.
+     *
+     * @param[in] c
+     *     This is the character to match against the character set.
+     *
+     * @param[out] matched
+     *     This is where to store an indication of whether or not
+     *     the character is in the set.
+     *
+     * @return
+     *     An indication of whether or not the character set is
+     *     well-formed is returned.  If not, the "[" should be
+     *     matched literally.
+     */
+    bool MatchCharacterSet(
+        const std::string& pattern,
+        size_t& position,
+        char c,
+        bool& matched
+    ) {
+        size_t i = position + 1;
+        bool negated = false;
+        if (
+            (i < pattern.length())
+            && (
+                (pattern[i] == '!')
+                || (pattern[i] == '^')
+            )
+        ) {
+            negated = true;
+            ++i;
+        }
+        matched = false;
+        bool first = true;
+        while (i < pattern.length()) {
+            if (
+                (pattern[i] == ']')
+                && !first
+            ) {
+                position = i + 1;
+                matched = (matched != negated);
+                return true;
+            }
+            first = false;
+            const auto low = pattern[i];
+            if (
+                (i + 2 < pattern.length())
+                && (pattern[i + 1] == '-')
+                && (pattern[i + 2] != ']')
+            ) {
+                const auto high = pattern[i + 2];
+                if (
+                    (c >= low)
+                    && (c <= high)
+                ) {
+                    matched = true;
+                }
+                i += 3;
+            } else {
+                if (c == low) {
+                    matched = true;
+                }
+                ++i;
+            }
+        }
+        return false;
+    }
+
+}
+
+bool GlobMatches(
+    const std::string& pattern,
+    const std::string& text
+) {
+    // Match greedily, backtracking to the most recent "*" on mismatch.
+    // Since "*" never matches "/", backtracking is abandoned whenever
+    // the "*" would have to swallow one.
+    size_t p = 0;
+    size_t t = 0;
+    size_t starPattern = std::string::npos;
+    size_t starText = 0;
+    while (t < text.length()) {
+        bool advanced = false;
+        if (p < pattern.length()) {
+            const auto c = text[t];
+            switch (pattern[p]) {
+                case '*': {
+                    starPattern = p++;
+                    starText = t;
+                    continue;
+                }
+
+                case '?': {
+                    if (c != '/') {
+                        ++p;
+                        advanced = true;
+                    }
+                } break;
+
+                case '[': {
+                    auto next = p;
+                    bool matched;
+                    if (MatchCharacterSet(pattern, next, c, matched)) {
+                        if (
+                            matched
+                            && (c != '/')
+                        ) {
+                            p = next;
+                            advanced = true;
+                        }
+                    } else if (c == '[') {
+                        ++p;
+                        advanced = true;
+                    }
+                } break;
+
+                case '\\': {
+                    if (
+                        (p + 1 < pattern.length())
+                        && (pattern[p + 1] == c)
+                    ) {
+                        p += 2;
+                        advanced = true;
+                    }
+                } break;
+
+                default: {
+                    if (pattern[p] == c) {
+                        ++p;
+                        advanced = true;
+                    }
+                } break;
+            }
+        }
+        if (advanced) {
+            ++t;
+        } else if (
+            (starPattern != std::string::npos)
+            && (text[starText] != '/')
+        ) {
+            p = starPattern + 1;
+            t = ++starText;
+        } else {
+            return false;
+        }
+    }
+    while (
+        (p < pattern.length())
+        && (pattern[p] == '*')
+    ) {
+        ++p;
+    }
+    return (p == pattern.length());
+}
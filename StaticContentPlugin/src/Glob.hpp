@@ -0,0 +1,40 @@
+#ifndef STATIC_CONTENT_PLUGIN_GLOB_HPP
+#define STATIC_CONTENT_PLUGIN_GLOB_HPP
+
+/**
+ * @file Glob.hpp
+ *
+ * This module declares the function used to match paths
+ * against shell-style wildcard patterns.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <string>
+
+/**
+ * This function determines whether or not the given text matches
+ * the given shell-style wildcard pattern, in which:
+ * - "*" matches any sequence of characters other than "/"
+ * - "?" matches any single character other than "/"
+ * - "[...]" matches any single character in the set, which may include
+ *   ranges such as "a-f", and is negated if it begins with "!" or "^"
+ * - "\" matches the character following it literally
+ * - any other character matches itself
+ *
+ * @param[in] pattern
+ *     This is the pattern to match.
+ *
+ * @param[in] text
+ *     This is the text to match against the pattern.
+ *
+ * @return
+ *     An indication of whether or not the text matches
+ *     the pattern is returned.
+ */
+bool GlobMatches(
+    const std::string& pattern,
+    const std::string& text
+);
+
+#endif /* STATIC_CONTENT_PLUGIN_GLOB_HPP */
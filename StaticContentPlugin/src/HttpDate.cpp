@@ -0,0 +1,295 @@
+/**
+ * @file HttpDate.cpp
+ *
+ * This module contains the implementation of the functions used to
+ * format and parse the dates used in HTTP headers.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "HttpDate.hpp"
+
+#include <stddef.h>
+#include <StringExtensions/StringExtensions.hpp>
+#include <vector>
+
+namespace {
+
+    /**
+     * These are the abbreviated names of the days of the week,
+     * starting with Sunday.
+     */
+    const char* const DAY_NAMES[] = {
+        "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat",
+    };
+
+    /**
+     * These are the abbreviated names of the months of the year.
+     */
+    const char* const MONTH_NAMES[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec",
+    };
+
+    /**
+     * This function returns the number of days between the UNIX epoch
+     * and the given date of the proleptic Gregorian calendar.
+     *
+     * @param[in] year
+     *     This is the year of the date.
+     *
+     * @param[in] month
+     *     This is the month of the date, from 1 to 12.
+     *
+     * @param[in] day
+     *     This is the day of the month of the date, from 1 to 31.
+     *
+     * @return
+     *     The number of days since the UNIX epoch is returned.
+     */
+    int64_t DaysFromCivil(
+        int64_t year,
+        int month,
+        int day
+    ) {
+        year -= (month <= 2) ? 1 : 0;
+        const int64_t era = ((year >= 0) ? year : year - 399) / 400;
+        const int64_t yearOfEra = year - era * 400;
+        const int64_t dayOfYear = (153 * (month + ((month > 2) ? -3 : 9)) + 2) / 5 + day - 1;
+        const int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    /**
+     * This function breaks down the given number of days since
+     * the UNIX epoch into a date of the proleptic Gregorian calendar.
+     *
+     * @param[in] days
+     *     This is the number of days since the UNIX epoch.
+     *
+     * @param[out] year
+     *     This is where to store the year of the date.
+     *
+     * @param[out] month
+     *     This is where to store the month of the date, from 1 to 12.
+     *
+     * @param[out] day
+     *     This is where to store the day of the month of the date,
+     *     from 1 to 31.
+     */
+    void CivilFromDays(
+        int64_t days,
+        int64_t& year,
+        int& month,
+        int& day
+    ) {
+        days += 719468;
+        const int64_t era = ((days >= 0) ? days : days - 146096) / 146097;
+        const int64_t dayOfEra = days - era * 146097;
+        const int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+        day = (int)(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+        month = (int)(monthIndex + ((monthIndex < 10) ? 3 : -9));
+        year = yearOfEra + era * 400 + ((month <= 2) ? 1 : 0);
+    }
+
+    /**
+     * This function parses the given string as a non-negative
+     * decimal integer of the given number of digits.
+     *
+     * @param[in] text
+     *     This is the string to parse.
+     *
+     * @param[in] minDigits
+     *     This is the smallest number of digits allowed.
+     *
+     * @param[in] maxDigits
+     *     This is the largest number of digits allowed.
+     *
+     * @param[out] value
+     *     This is where to store the parsed value.
+     *
+     * @return
+     *     An indication of whether or not the string was valid
+     *     is returned.
+     */
+    bool ParseDigits(
+        const std::string& text,
+        size_t minDigits,
+        size_t maxDigits,
+        int& value
+    ) {
+        if (
+            (text.length() < minDigits)
+            || (text.length() > maxDigits)
+        ) {
+            return false;
+        }
+        value = 0;
+        for (const auto c: text) {
+            if (
+                (c < '0')
+                || (c > '9')
+            ) {
+                return false;
+            }
+            value = value * 10 + (c - '0');
+        }
+        return true;
+    }
+
+    /**
+     * This function parses the given abbreviated month name.
+     *
+     * @param[in] text
+     *     This is the month name to parse.
+     *
+     * @param[out] month
+     *     This is where to store the month, from 1 to 12.
+     *
+     * @return
+     *     An indication of whether or not the month name was valid
+     *     is returned.
+     */
+    bool ParseMonth(
+        const std::string& text,
+        int& month
+    ) {
+        for (int i = 0; i < 12; ++i) {
+            if (text == MONTH_NAMES[i]) {
+                month = i + 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * This function parses the given "HH:MM:SS" time of day.
+     *
+     * @param[in] text
+     *     This is the time of day to parse.
+     *
+     * @param[out] seconds
+     *     This is where to store the number of seconds since midnight.
+     *
+     * @return
+     *     An indication of whether or not the time of day was valid
+     *     is returned.
+     */
+    bool ParseTimeOfDay(
+        const std::string& text,
+        int& seconds
+    ) {
+        const auto parts = StringExtensions::Split(text, ':');
+        int hour, minute, second;
+        if (
+            (parts.size() != 3)
+            || !ParseDigits(parts[0], 2, 2, hour)
+            || !ParseDigits(parts[1], 2, 2, minute)
+            || !ParseDigits(parts[2], 2, 2, second)
+            || (hour > 23)
+            || (minute > 59)
+            || (second > 60)
+        ) {
+            return false;
+        }
+        seconds = hour * 3600 + minute * 60 + second;
+        return true;
+    }
+
+}
+
+std::string FormatHttpDate(int64_t time) {
+    int64_t days = time / 86400;
+    int64_t secondOfDay = time % 86400;
+    if (secondOfDay < 0) {
+        secondOfDay += 86400;
+        --days;
+    }
+    int64_t year;
+    int month, day;
+    CivilFromDays(days, year, month, day);
+    const auto weekday = (int)(((days % 7) + 11) % 7);
+    return StringExtensions::sprintf(
+        "%s, %02d %s %04d %02d:%02d:%02d GMT",
+        DAY_NAMES[weekday],
+        day,
+        MONTH_NAMES[month - 1],
+        (int)year,
+        (int)(secondOfDay / 3600),
+        (int)(secondOfDay / 60 % 60),
+        (int)(secondOfDay % 60)
+    );
+}
+
+bool ParseHttpDate(
+    const std::string& date,
+    int64_t& time
+) {
+    std::vector< std::string > fields;
+    for (const auto& field: StringExtensions::Split(StringExtensions::Trim(date), ' ')) {
+        if (!field.empty()) {
+            fields.push_back(field);
+        }
+    }
+    int year, month, day, secondOfDay;
+    if (
+        (fields.size() == 6)
+        && (fields[0].length() == 4)
+        && (fields[0].back() == ',')
+        && (fields[5] == "GMT")
+    ) {
+        // IMF-fixdate: "Sun, 06 Nov 1994 08:49:37 GMT"
+        if (
+            !ParseDigits(fields[1], 2, 2, day)
+            || !ParseMonth(fields[2], month)
+            || !ParseDigits(fields[3], 4, 4, year)
+            || !ParseTimeOfDay(fields[4], secondOfDay)
+        ) {
+            return false;
+        }
+    } else if (
+        (fields.size() == 4)
+        && (fields[0].back() == ',')
+        && (fields[3] == "GMT")
+    ) {
+        // RFC 850: "Sunday, 06-Nov-94 08:49:37 GMT"
+        const auto dateParts = StringExtensions::Split(fields[1], '-');
+        if (
+            (dateParts.size() != 3)
+            || !ParseDigits(dateParts[0], 2, 2, day)
+            || !ParseMonth(dateParts[1], month)
+            || !ParseDigits(dateParts[2], 2, 2, year)
+            || !ParseTimeOfDay(fields[2], secondOfDay)
+        ) {
+            return false;
+        }
+
+        // RFC 7231 says to interpret two-digit years which appear to be
+        // more than 50 years in the future as being in the past; lacking
+        // the current date here, the years 1970-2069 are assumed.
+        year += (year < 70) ? 2000 : 1900;
+    } else if (fields.size() == 5) {
+        // asctime(): "Sun Nov  6 08:49:37 1994"
+        if (
+            !ParseMonth(fields[1], month)
+            || !ParseDigits(fields[2], 1, 2, day)
+            || !ParseTimeOfDay(fields[3], secondOfDay)
+            || !ParseDigits(fields[4], 4, 4, year)
+        ) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    if (
+        (day < 1)
+        || (day > 31)
+    ) {
+        return false;
+    }
+    time = DaysFromCivil(year, month, day) * 86400 + secondOfDay;
+    return true;
+}
@@ -0,0 +1,49 @@
+#ifndef STATIC_CONTENT_PLUGIN_HTTP_DATE_HPP
+#define STATIC_CONTENT_PLUGIN_HTTP_DATE_HPP
+
+/**
+ * @file HttpDate.hpp
+ *
+ * This module declares the functions used to format and parse
+ * the dates used in HTTP headers such as "Last-Modified".
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * This function formats the given time as an HTTP-date in the
+ * preferred "IMF-fixdate" format of RFC 7231, such as
+ * "Sun, 06 Nov 1994 08:49:37 GMT".
+ *
+ * @param[in] time
+ *     This is the time to format, in seconds since the UNIX epoch.
+ *
+ * @return
+ *     The formatted date is returned.
+ */
+std::string FormatHttpDate(int64_t time);
+
+/**
+ * This function parses the given HTTP-date, accepting any of the
+ * three formats recognized by RFC 7231 ("IMF-fixdate", the obsolete
+ * RFC 850 format, and the ANSI C asctime() format).
+ *
+ * @param[in] date
+ *     This is the date to parse.
+ *
+ * @param[out] time
+ *     This is where to store the parsed time, in seconds
+ *     since the UNIX epoch.
+ *
+ * @return
+ *     An indication of whether or not the date was valid is returned.
+ */
+bool ParseHttpDate(
+    const std::string& date,
+    int64_t& time
+);
+
+#endif /* STATIC_CONTENT_PLUGIN_HTTP_DATE_HPP */
@@ -0,0 +1,206 @@
+/**
+ * @file MimeTypes.cpp
+ *
+ * This module contains the built-in table of MIME types and
+ * the function used to look them up.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "MimeTypes.hpp"
+
+namespace {
+
+    /**
+     * This is the table of built-in MIME types, which must be kept
+     * sorted by extension, since it's searched with a binary search.
+     */
+    constexpr MimeType MIME_TYPES[] = {
+        {"3gp", "video/3gpp", false},
+        {"7z", "application/x-7z-compressed", false},
+        {"aac", "audio/aac", false},
+        {"apng", "image/apng", false},
+        {"atom", "application/atom+xml", true},
+        {"avif", "image/avif", false},
+        {"bmp", "image/bmp", true},
+        {"css", "text/css", true},
+        {"csv", "text/csv", true},
+        {"eot", "application/vnd.ms-fontobject", true},
+        {"flac", "audio/flac", false},
+        {"gif", "image/gif", false},
+        {"gz", "application/gzip", false},
+        {"htm", "text/html", true},
+        {"html", "text/html", true},
+        {"ico", "image/x-icon", false},
+        {"ics", "text/calendar", true},
+        {"jpeg", "image/jpeg", false},
+        {"jpg", "image/jpeg", false},
+        {"js", "application/javascript", true},
+        {"json", "application/json", true},
+        {"jsonld", "application/ld+json", true},
+        {"m4a", "audio/mp4", false},
+        {"map", "application/json", true},
+        {"md", "text/markdown", true},
+        {"mjs", "application/javascript", true},
+        {"mp3", "audio/mpeg", false},
+        {"mp4", "video/mp4", false},
+        {"mpeg", "video/mpeg", false},
+        {"oga", "audio/ogg", false},
+        {"ogg", "audio/ogg", false},
+        {"ogv", "video/ogg", false},
+        {"opus", "audio/opus", false},
+        {"otf", "font/otf", true},
+        {"pdf", "application/pdf", false},
+        {"png", "image/png", false},
+        {"rss", "application/rss+xml", true},
+        {"svg", "image/svg+xml", true},
+        {"tar", "application/x-tar", true},
+        {"tif", "image/tiff", false},
+        {"tiff", "image/tiff", false},
+        {"ttf", "font/ttf", true},
+        {"txt", "text/plain", true},
+        {"wasm", "application/wasm", true},
+        {"wav", "audio/wav", false},
+        {"weba", "audio/webm", false},
+        {"webm", "video/webm", false},
+        {"webmanifest", "application/manifest+json", true},
+        {"webp", "image/webp", false},
+        {"woff", "font/woff", false},
+        {"woff2", "font/woff2", false},
+        {"xhtml", "application/xhtml+xml", true},
+        {"xml", "application/xml", true},
+        {"zip", "application/zip", false},
+    };
+
+    /**
+     * This is the number of entries in the table of built-in MIME types.
+     */
+    constexpr size_t NUM_MIME_TYPES = sizeof(MIME_TYPES) / sizeof(MIME_TYPES[0]);
+
+    /**
+     * This function compares the given null-terminated strings
+     * at compile time.
+     *
+     * @param[in] lhs
+     *     This is the first string to compare.
+     *
+     * @param[in] rhs
+     *     This is the second string to compare.
+     *
+     * @return
+     *     An indication of whether or not the first string sorts
+     *     before the second string is returned.
+     */
+    constexpr bool IsLess(const char* lhs, const char* rhs) {
+        return (
+            (*rhs == '\0')
+            ? false
+            : (
+                (*lhs < *rhs)
+                || (
+                    (*lhs == *rhs)
+                    && IsLess(lhs + 1, rhs + 1)
+                )
+            )
+        );
+    }
+
+    /**
+     * This function checks at compile time that the table of built-in
+     * MIME types is sorted by extension, starting at the given entry.
+     *
+     * @param[in] i
+     *     This is the index of the first entry to check.
+     *
+     * @return
+     *     An indication of whether or not the table is sorted
+     *     from the given entry onward is returned.
+     */
+    constexpr bool IsSorted(size_t i = 0) {
+        return (
+            (i + 1 >= NUM_MIME_TYPES)
+            || (
+                IsLess(MIME_TYPES[i].extension, MIME_TYPES[i + 1].extension)
+                && IsSorted(i + 1)
+            )
+        );
+    }
+
+    static_assert(IsSorted(), "MIME_TYPES must be sorted by extension");
+
+    /**
+     * This function compares the given extension, without regard to case,
+     * with the given lower-case, null-terminated extension.
+     *
+     * @param[in] extension
+     *     This points to the extension to compare.
+     *
+     * @param[in] length
+     *     This is the length of the extension to compare.
+     *
+     * @param[in] tableExtension
+     *     This is the lower-case, null-terminated extension
+     *     with which to compare.
+     *
+     * @return
+     *     A negative number is returned if the given extension sorts
+     *     before the table extension, a positive number if it sorts
+     *     after, and zero if they are equal.
+     */
+    int CompareExtension(
+        const char* extension,
+        size_t length,
+        const char* tableExtension
+    ) {
+        for (size_t i = 0; i < length; ++i) {
+            auto c = extension[i];
+            if (
+                (c >= 'A')
+                && (c <= 'Z')
+            ) {
+                c += 'a' - 'A';
+            }
+            const auto t = tableExtension[i];
+            if (t == '\0') {
+                return 1;
+            }
+            if (c != t) {
+                return (
+                    ((unsigned char)c < (unsigned char)t)
+                    ? -1
+                    : 1
+                );
+            }
+        }
+        return (
+            (tableExtension[length] == '\0')
+            ? 0
+            : -1
+        );
+    }
+
+}
+
+const MimeType* FindMimeType(
+    const char* extension,
+    size_t length
+) {
+    size_t low = 0;
+    size_t high = NUM_MIME_TYPES;
+    while (low < high) {
+        const auto middle = low + (high - low) / 2;
+        const auto comparison = CompareExtension(
+            extension,
+            length,
+            MIME_TYPES[middle].extension
+        );
+        if (comparison == 0) {
+            return &MIME_TYPES[middle];
+        } else if (comparison < 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return nullptr;
+}
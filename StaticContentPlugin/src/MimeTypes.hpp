@@ -0,0 +1,59 @@
+#ifndef STATIC_CONTENT_PLUGIN_MIME_TYPES_HPP
+#define STATIC_CONTENT_PLUGIN_MIME_TYPES_HPP
+
+/**
+ * @file MimeTypes.hpp
+ *
+ * This module declares the MimeType structure and the function
+ * used to look up the built-in MIME type for a file name extension.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <stddef.h>
+
+/**
+ * This describes the MIME type of files having a particular extension.
+ */
+struct MimeType {
+    /**
+     * This is the file name extension, in lower case and without
+     * the leading period.
+     */
+    const char* extension;
+
+    /**
+     * This is the value to give in the "Content-Type" header
+     * for files with the extension.
+     */
+    const char* contentType;
+
+    /**
+     * This indicates whether or not files of this type benefit
+     * from being compressed.
+     */
+    bool compressible;
+};
+
+/**
+ * This function looks up the built-in MIME type for files having
+ * the given extension.  The extension is matched without regard to case.
+ * No memory is allocated.
+ *
+ * @param[in] extension
+ *     This points to the file name extension, without the leading period.
+ *     It need not be null-terminated.
+ *
+ * @param[in] length
+ *     This is the length of the extension, in characters.
+ *
+ * @return
+ *     The MIME type for the extension is returned.  If the extension
+ *     isn't recognized, nullptr is returned.
+ */
+const MimeType* FindMimeType(
+    const char* extension,
+    size_t length
+);
+
+#endif /* STATIC_CONTENT_PLUGIN_MIME_TYPES_HPP */
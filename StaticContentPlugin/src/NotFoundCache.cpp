@@ -0,0 +1,166 @@
+/**
+ * @file NotFoundCache.cpp
+ *
+ * This module contains the implementation of the NotFoundCache class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "NotFoundCache.hpp"
+#include "PathFilter.hpp"
+#include "PathIndex.hpp"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * This contains the private properties of the NotFoundCache class.
+ */
+struct NotFoundCache::Impl {
+    // Types
+
+    /**
+     * This is the type used to keep track of the order in which
+     * missing paths were last requested, most recently requested first.
+     */
+    typedef std::list< std::string > RecencyList;
+
+    // Properties
+
+    /**
+     * This is used to synchronize access to the cache.
+     */
+    mutable std::mutex mutex;
+
+    /**
+     * This is the maximum number of missing paths to remember.
+     */
+    size_t capacity = 0;
+
+    /**
+     * This indicates whether or not to build a Bloom filter
+     * over the files in the tree whenever the cache is reset.
+     */
+    bool useFilter = false;
+
+    /**
+     * This is the Bloom filter over the files in the tree, if any.
+     */
+    std::shared_ptr< const PathFilter > filter;
+
+    /**
+     * These are the paths remembered as missing, along with their
+     * positions in the recency list.
+     */
+    std::unordered_map< std::string, RecencyList::iterator > missing;
+
+    /**
+     * This keeps track of the order in which missing paths were
+     * last requested, most recently requested first.
+     */
+    RecencyList recency;
+
+    /**
+     * This is the current generation of the cache, which is advanced
+     * every time the cache is reset.
+     */
+    uint64_t generation = 0;
+};
+
+NotFoundCache::~NotFoundCache() noexcept = default;
+
+NotFoundCache::NotFoundCache(
+    size_t capacity,
+    bool useFilter
+)
+    : impl_(new Impl())
+{
+    impl_->capacity = capacity;
+    impl_->useFilter = useFilter;
+}
+
+void NotFoundCache::Reset(
+    const std::vector< std::string >& files,
+    bool isComplete
+) {
+    // Build the new filter before taking the lock, since it
+    // may take a while for a large tree.
+    std::shared_ptr< PathFilter > filter;
+    if (
+        impl_->useFilter
+        && isComplete
+    ) {
+        // The directories holding the files are added as well, since
+        // requests for directories may be redirected to their index files.
+        std::unordered_set< std::string > directories;
+        for (const auto& file: files) {
+            for (
+                auto delimiter = file.find('/');
+                delimiter != std::string::npos;
+                delimiter = file.find('/', delimiter + 1)
+            ) {
+                (void)directories.insert(file.substr(0, delimiter));
+            }
+        }
+        filter = std::make_shared< PathFilter >(files.size() + directories.size());
+        for (const auto& file: files) {
+            filter->Add(file);
+        }
+        for (const auto& directory: directories) {
+            filter->Add(directory);
+        }
+    }
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    impl_->filter = filter;
+    impl_->missing.clear();
+    impl_->recency.clear();
+    ++impl_->generation;
+}
+
+uint64_t NotFoundCache::GetGeneration() const {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    return impl_->generation;
+}
+
+bool NotFoundCache::IsMissing(const std::string& path) {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    if (
+        (impl_->filter != nullptr)
+        && !impl_->filter->MightContain(path)
+        && PathIndex::IsCanonical(path)
+    ) {
+        return true;
+    }
+    const auto missing = impl_->missing.find(path);
+    if (missing == impl_->missing.end()) {
+        return false;
+    }
+    impl_->recency.splice(
+        impl_->recency.begin(),
+        impl_->recency,
+        missing->second
+    );
+    return true;
+}
+
+void NotFoundCache::MarkMissing(
+    const std::string& path,
+    uint64_t generation
+) {
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    if (
+        (generation != impl_->generation)
+        || (impl_->capacity == 0)
+        || (impl_->missing.find(path) != impl_->missing.end())
+    ) {
+        return;
+    }
+    if (impl_->missing.size() >= impl_->capacity) {
+        (void)impl_->missing.erase(impl_->recency.back());
+        impl_->recency.pop_back();
+    }
+    impl_->recency.push_front(path);
+    impl_->missing[path] = impl_->recency.begin();
+}
@@ -0,0 +1,136 @@
+#ifndef STATIC_CONTENT_PLUGIN_NOT_FOUND_CACHE_HPP
+#define STATIC_CONTENT_PLUGIN_NOT_FOUND_CACHE_HPP
+
+/**
+ * @file NotFoundCache.hpp
+ *
+ * This module declares the NotFoundCache class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * This class remembers which paths within a watched directory tree
+ * were recently found not to exist, so that requests for them can be
+ * turned away without looking them up in the file system again.
+ *
+ * The number of paths remembered is bounded.  When room is needed for
+ * another path, the least recently requested path is forgotten.
+ *
+ * Optionally, the cache also holds a Bloom filter (see PathFilter) over
+ * all the files in the tree, and the directories holding them, which
+ * rules out most paths the first time they're requested.
+ *
+ * Everything the cache knows is replaced whenever the tree changes.
+ * Like ContentCache, the cache has a generation, advanced every time
+ * it's reset, so that a path found missing just before the tree
+ * changes isn't remembered afterwards.
+ */
+class NotFoundCache {
+    // Lifecycle Methods
+public:
+    ~NotFoundCache() noexcept;
+    NotFoundCache(const NotFoundCache&) = delete;
+    NotFoundCache(NotFoundCache&&) noexcept = delete;
+    NotFoundCache& operator=(const NotFoundCache&) = delete;
+    NotFoundCache& operator=(NotFoundCache&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     *
+     * @param[in] capacity
+     *     This is the maximum number of missing paths to remember.
+     *
+     * @param[in] useFilter
+     *     This indicates whether or not to build a Bloom filter
+     *     over the files in the tree whenever it's reset.
+     */
+    NotFoundCache(
+        size_t capacity,
+        bool useFilter
+    );
+
+    /**
+     * This method forgets all the paths remembered as missing,
+     * rebuilds the Bloom filter (if used) from the given files
+     * and their directories, and advances the generation of the cache.
+     *
+     * @param[in] files
+     *     These are the paths of all the files in the tree, relative
+     *     to the root of the tree.
+     *
+     * @param[in] isComplete
+     *     This indicates whether or not the given files are all the
+     *     paths through which files in the tree may be reached.
+     *     If not, no Bloom filter is used until the next reset.
+     */
+    void Reset(
+        const std::vector< std::string >& files,
+        bool isComplete
+    );
+
+    /**
+     * This method returns the current generation of the cache.
+     *
+     * @return
+     *     The current generation of the cache is returned.
+     */
+    uint64_t GetGeneration() const;
+
+    /**
+     * This method checks whether or not the given path is known
+     * not to exist in the tree.
+     *
+     * @param[in] path
+     *     This is the path to check, relative to the root of the tree.
+     *     Paths which aren't in canonical form (which have empty, "."
+     *     or ".." segments) are never ruled out by the Bloom filter.
+     *
+     * @return
+     *     An indication of whether or not the path is known not to
+     *     exist in the tree is returned.
+     */
+    bool IsMissing(const std::string& path);
+
+    /**
+     * This method remembers that the given path was found not to exist
+     * in the tree, unless the cache has been reset since the given
+     * generation.
+     *
+     * @param[in] path
+     *     This is the path which was found not to exist, relative
+     *     to the root of the tree.
+     *
+     * @param[in] generation
+     *     This is the generation of the cache noted before the path
+     *     was looked up in the file system.
+     */
+    void MarkMissing(
+        const std::string& path,
+        uint64_t generation
+    );
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* STATIC_CONTENT_PLUGIN_NOT_FOUND_CACHE_HPP */
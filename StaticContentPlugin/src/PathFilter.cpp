@@ -0,0 +1,126 @@
+/**
+ * @file PathFilter.cpp
+ *
+ * This module contains the implementation of the PathFilter class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "PathFilter.hpp"
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of bits of the filter to use for each path.
+     * Along with HASH_COUNT, this gives a false positive rate of
+     * about one percent.
+     */
+    constexpr size_t BITS_PER_PATH = 10;
+
+    /**
+     * This is the number of bits of the filter set for each path.
+     */
+    constexpr size_t HASH_COUNT = 7;
+
+    /**
+     * This function computes a hash of the given path, ignoring
+     * the case of letters, using the 64-bit FNV-1a algorithm.
+     *
+     * @param[in] path
+     *     This is the path to hash.
+     *
+     * @return
+     *     The hash of the path is returned.
+     */
+    uint64_t HashPath(const std::string& path) {
+        uint64_t hash = 0xcbf29ce484222325;
+        for (auto c: path) {
+            if (
+                (c >= 'A')
+                && (c <= 'Z')
+            ) {
+                c += 'a' - 'A';
+            }
+            hash ^= (uint8_t)c;
+            hash *= 0x100000001b3;
+        }
+        return hash;
+    }
+
+    /**
+     * This function derives a second, independent hash from the given
+     * hash, using the finalizer of the SplitMix64 generator.  The result
+     * is always odd, so that it can be used as a step which eventually
+     * visits every bit of a filter whose size is a power of two.
+     *
+     * @param[in] hash
+     *     This is the hash from which to derive the second hash.
+     *
+     * @return
+     *     The second hash is returned.
+     */
+    uint64_t RehashPath(uint64_t hash) {
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+        return (hash ^ (hash >> 31)) | 1;
+    }
+
+}
+
+/**
+ * This contains the private properties of the PathFilter class.
+ */
+struct PathFilter::Impl {
+    // Properties
+
+    /**
+     * These are the bits of the filter.
+     */
+    std::vector< uint64_t > words;
+
+    /**
+     * This is one less than the number of bits in the filter,
+     * which is a power of two.
+     */
+    uint64_t mask = 0;
+};
+
+PathFilter::~PathFilter() noexcept = default;
+
+PathFilter::PathFilter(size_t expectedPaths)
+    : impl_(new Impl())
+{
+    uint64_t bits = 64;
+    while (bits < (uint64_t)std::max(expectedPaths, (size_t)1) * BITS_PER_PATH) {
+        bits <<= 1;
+    }
+    impl_->words.resize((size_t)(bits / 64));
+    impl_->mask = bits - 1;
+}
+
+void PathFilter::Add(const std::string& path) {
+    auto hash = HashPath(path);
+    const auto step = RehashPath(hash);
+    for (size_t i = 0; i < HASH_COUNT; ++i) {
+        const auto bit = hash & impl_->mask;
+        impl_->words[(size_t)(bit / 64)] |= ((uint64_t)1 << (bit % 64));
+        hash += step;
+    }
+}
+
+bool PathFilter::MightContain(const std::string& path) const {
+    auto hash = HashPath(path);
+    const auto step = RehashPath(hash);
+    for (size_t i = 0; i < HASH_COUNT; ++i) {
+        const auto bit = hash & impl_->mask;
+        if ((impl_->words[(size_t)(bit / 64)] & ((uint64_t)1 << (bit % 64))) == 0) {
+            return false;
+        }
+        hash += step;
+    }
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef STATIC_CONTENT_PLUGIN_PATH_FILTER_HPP
+#define STATIC_CONTENT_PLUGIN_PATH_FILTER_HPP
+
+/**
+ * @file PathFilter.hpp
+ *
+ * This module declares the PathFilter class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <string>
+
+/**
+ * This class is a Bloom filter over a set of paths.  It can say for
+ * sure that a path is not in the set, using ten to twenty bits per path
+ * and without allocating any memory, but it may mistake about one in
+ * a hundred paths not in the set for paths which are.
+ *
+ * Letters are compared without regard to case, so that the filter
+ * never rules out a path which a case-insensitive file system
+ * would find.
+ */
+class PathFilter {
+    // Lifecycle Methods
+public:
+    ~PathFilter() noexcept;
+    PathFilter(const PathFilter&) = delete;
+    PathFilter(PathFilter&&) noexcept = delete;
+    PathFilter& operator=(const PathFilter&) = delete;
+    PathFilter& operator=(PathFilter&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     *
+     * @param[in] expectedPaths
+     *     This is the number of paths expected to be added to
+     *     the filter, which determines its size.
+     */
+    explicit PathFilter(size_t expectedPaths);
+
+    /**
+     * This method adds the given path to the filter.
+     *
+     * @param[in] path
+     *     This is the path to add.
+     */
+    void Add(const std::string& path);
+
+    /**
+     * This method checks whether or not the given path
+     * may have been added to the filter.
+     *
+     * @param[in] path
+     *     This is the path to check.
+     *
+     * @return
+     *     An indication of whether or not the path may have been
+     *     added to the filter is returned.  If false, the path
+     *     was definitely not added.
+     */
+    bool MightContain(const std::string& path) const;
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* STATIC_CONTENT_PLUGIN_PATH_FILTER_HPP */
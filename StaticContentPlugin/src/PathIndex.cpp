@@ -0,0 +1,118 @@
+/**
+ * @file PathIndex.cpp
+ *
+ * This module contains the implementation of the PathIndex class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "PathIndex.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * This contains the private properties of the PathIndex class.
+ */
+struct PathIndex::Impl {
+    // Types
+
+    /**
+     * This is the type used to map the paths of files relative to
+     * the root of the tree to their full file system paths.
+     */
+    typedef std::unordered_map< std::string, std::string > Files;
+
+    // Properties
+
+    /**
+     * This is used to synchronize access to the index.
+     */
+    mutable std::mutex mutex;
+
+    /**
+     * This is the file system path of the root of the tree.
+     */
+    std::string root;
+
+    /**
+     * These are the files in the tree, if the index can be used.
+     * The map is never changed once made, so lookups only hold
+     * the lock long enough to take a reference to it.
+     */
+    std::shared_ptr< const Files > files;
+};
+
+PathIndex::~PathIndex() noexcept = default;
+
+PathIndex::PathIndex(const std::string& root)
+    : impl_(new Impl())
+{
+    impl_->root = root;
+}
+
+void PathIndex::Reset(
+    const std::vector< std::string >& files,
+    bool isComplete
+) {
+    // Build the new index before taking the lock, since it
+    // may take a while for a large tree.
+    std::shared_ptr< Impl::Files > newFiles;
+    if (isComplete) {
+        newFiles = std::make_shared< Impl::Files >(files.size());
+        for (const auto& file: files) {
+            (*newFiles)[file] = impl_->root + "/" + file;
+        }
+    }
+    std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+    impl_->files = newFiles;
+}
+
+bool PathIndex::Find(
+    const std::string& relativePath,
+    std::shared_ptr< const std::string >& path
+) const {
+    std::shared_ptr< const Impl::Files > files;
+    {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        files = impl_->files;
+    }
+    if (
+        (files == nullptr)
+        || !IsCanonical(relativePath)
+    ) {
+        return false;
+    }
+    const auto file = files->find(relativePath);
+    if (file == files->end()) {
+        path = nullptr;
+    } else {
+        // The path returned shares ownership of the whole index,
+        // so that it stays valid if the index is replaced meanwhile,
+        // without having to be copied.
+        path = std::shared_ptr< const std::string >(files, &file->second);
+    }
+    return true;
+}
+
+bool PathIndex::IsCanonical(const std::string& path) {
+    size_t segmentStart = 0;
+    for (size_t i = 0; i <= path.length(); ++i) {
+        if (
+            (i < path.length())
+            && (path[i] != '/')
+        ) {
+            continue;
+        }
+        const auto segmentLength = i - segmentStart;
+        if (
+            (segmentLength == 0)
+            || (path.compare(segmentStart, segmentLength, ".") == 0)
+            || (path.compare(segmentStart, segmentLength, "..") == 0)
+        ) {
+            return false;
+        }
+        segmentStart = i + 1;
+    }
+    return true;
+}
@@ -0,0 +1,115 @@
+#ifndef STATIC_CONTENT_PLUGIN_PATH_INDEX_HPP
+#define STATIC_CONTENT_PLUGIN_PATH_INDEX_HPP
+
+/**
+ * @file PathIndex.hpp
+ *
+ * This module declares the PathIndex class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * This class holds an index of all the files in a watched directory
+ * tree, mapping the path of each file relative to the root of the tree
+ * to its full file system path, so that requests can be resolved to
+ * files with a single hash table lookup, and requests for files which
+ * aren't in the tree can be turned away without consulting the file
+ * system at all.
+ *
+ * The index is replaced whenever the tree changes.  It's only used
+ * while every file in the tree is reachable by exactly one path, and
+ * only for paths in canonical form, since otherwise a file could be
+ * reached by a path which isn't in the index.
+ */
+class PathIndex {
+    // Lifecycle Methods
+public:
+    ~PathIndex() noexcept;
+    PathIndex(const PathIndex&) = delete;
+    PathIndex(PathIndex&&) noexcept = delete;
+    PathIndex& operator=(const PathIndex&) = delete;
+    PathIndex& operator=(PathIndex&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     *
+     * @param[in] root
+     *     This is the file system path of the root of the tree.
+     */
+    explicit PathIndex(const std::string& root);
+
+    /**
+     * This method replaces the index with one of the given files.
+     *
+     * @param[in] files
+     *     These are the paths of all the files in the tree, relative
+     *     to the root of the tree.
+     *
+     * @param[in] isComplete
+     *     This indicates whether or not the given files are all the
+     *     paths through which files in the tree may be reached.
+     *     If not, the index isn't used until the next reset.
+     */
+    void Reset(
+        const std::vector< std::string >& files,
+        bool isComplete
+    );
+
+    /**
+     * This method looks up the file at the given path in the index.
+     *
+     * @param[in] relativePath
+     *     This is the path of the file, relative to the root of the tree.
+     *
+     * @param[out] path
+     *     This is where to store the file system path of the file,
+     *     or nullptr if there is no file at the given path.
+     *
+     * @return
+     *     An indication of whether or not the index could be used to
+     *     look up the path is returned.  If not, the file system has
+     *     to be consulted instead.
+     */
+    bool Find(
+        const std::string& relativePath,
+        std::shared_ptr< const std::string >& path
+    ) const;
+
+    /**
+     * This function determines whether or not the given path is in
+     * canonical form, meaning none of its segments are empty, ".",
+     * or "..", so that it's the only path leading to the file it names
+     * (setting aside symbolic links and the case of letters).
+     *
+     * @param[in] path
+     *     This is the path to check.
+     *
+     * @return
+     *     An indication of whether or not the given path
+     *     is in canonical form is returned.
+     */
+    static bool IsCanonical(const std::string& path);
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* STATIC_CONTENT_PLUGIN_PATH_INDEX_HPP */
@@ -0,0 +1,195 @@
+/**
+ * @file Preloader.cpp
+ *
+ * This module contains the implementation of the Preloader class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "Preloader.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <inttypes.h>
+#include <set>
+#include <StringExtensions/StringExtensions.hpp>
+#include <SystemAbstractions/File.hpp>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of files to load between progress reports.
+     */
+    constexpr size_t PROGRESS_INTERVAL = 1000;
+
+}
+
+/**
+ * This contains the private properties of the Preloader class.
+ */
+struct Preloader::Impl {
+    // Properties
+
+    /**
+     * This is the function to call to publish any diagnostic messages.
+     */
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate;
+
+    /**
+     * This is the path of the directory at the root of the tree.
+     */
+    std::string root;
+
+    /**
+     * This is the function to call for each file found in the tree.
+     */
+    LoadDelegate loadDelegate;
+
+    /**
+     * This thread walks the directory tree.
+     */
+    std::thread worker;
+
+    /**
+     * This flag indicates whether or not the worker thread
+     * should stop walking the directory tree.
+     */
+    std::atomic< bool > stop{false};
+
+    /**
+     * This flag indicates whether or not the worker thread
+     * has finished walking the directory tree.
+     */
+    std::atomic< bool > finished{false};
+
+    // Methods
+
+    /**
+     * This function is called in its own worker thread.  It walks the
+     * directory tree, handing each file to the load delegate, and
+     * reports its progress.
+     */
+    void Run() {
+        const auto startTime = std::chrono::steady_clock::now();
+        diagnosticMessageDelegate(
+            "Preloader",
+            0,
+            StringExtensions::sprintf(
+                "preloading '%s'",
+                root.c_str()
+            )
+        );
+        size_t filesFound = 0;
+        size_t filesLoaded = 0;
+        uint64_t bytesLoaded = 0;
+        std::set< uint64_t > seen;
+        std::vector< std::string > unvisited{root};
+        bool done = false;
+        while (
+            !unvisited.empty()
+            && !done
+        ) {
+            const auto directory = std::move(unvisited.back());
+            unvisited.pop_back();
+            FileInfo directoryInfo;
+            if (
+                !GetFileInfo(directory, directoryInfo)
+                || !seen.insert(directoryInfo.inode).second
+            ) {
+                continue;
+            }
+            std::vector< std::string > children;
+            SystemAbstractions::File::ListDirectory(directory, children);
+            for (const auto& child: children) {
+                if (stop) {
+                    done = true;
+                    break;
+                }
+                FileInfo fileInfo;
+                if (!GetFileInfo(child, fileInfo)) {
+                    continue;
+                }
+                if (fileInfo.isDirectory) {
+                    unvisited.push_back(child);
+                    continue;
+                }
+                ++filesFound;
+                const auto result = loadDelegate(child, fileInfo);
+                if (result == Result::Loaded) {
+                    ++filesLoaded;
+                    bytesLoaded += fileInfo.size;
+                    if (filesLoaded % PROGRESS_INTERVAL == 0) {
+                        diagnosticMessageDelegate(
+                            "Preloader",
+                            0,
+                            StringExtensions::sprintf(
+                                "preloaded %zu files (%" PRIu64 " bytes) from '%s' so far",
+                                filesLoaded,
+                                bytesLoaded,
+                                root.c_str()
+                            )
+                        );
+                    }
+                } else if (result == Result::Stop) {
+                    done = true;
+                    break;
+                }
+            }
+        }
+        const auto elapsed = std::chrono::duration_cast< std::chrono::milliseconds >(
+            std::chrono::steady_clock::now() - startTime
+        );
+        diagnosticMessageDelegate(
+            "Preloader",
+            0,
+            StringExtensions::sprintf(
+                "preloaded %zu of %zu files (%" PRIu64 " bytes) from '%s' in %lld ms%s",
+                filesLoaded,
+                filesFound,
+                bytesLoaded,
+                root.c_str(),
+                (long long)elapsed.count(),
+                (done ? " (stopped early)" : "")
+            )
+        );
+        finished = true;
+    }
+};
+
+Preloader::~Preloader() noexcept {
+    Stop();
+}
+
+Preloader::Preloader(
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
+)
+    : impl_(new Impl())
+{
+    impl_->diagnosticMessageDelegate = diagnosticMessageDelegate;
+}
+
+void Preloader::Start(
+    const std::string& root,
+    LoadDelegate loadDelegate
+) {
+    Stop();
+    impl_->root = root;
+    impl_->loadDelegate = loadDelegate;
+    impl_->stop = false;
+    impl_->finished = false;
+    impl_->worker = std::thread(&Impl::Run, impl_.get());
+}
+
+void Preloader::Stop() {
+    if (!impl_->worker.joinable()) {
+        return;
+    }
+    impl_->stop = true;
+    impl_->worker.join();
+}
+
+bool Preloader::IsFinished() const {
+    return impl_->finished;
+}
@@ -0,0 +1,133 @@
+#ifndef STATIC_CONTENT_PLUGIN_PRELOADER_HPP
+#define STATIC_CONTENT_PLUGIN_PRELOADER_HPP
+
+/**
+ * @file Preloader.hpp
+ *
+ * This module declares the Preloader class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "FileInfo.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <SystemAbstractions/DiagnosticsSender.hpp>
+
+/**
+ * This class walks a directory tree on a worker thread, handing each
+ * file found to a delegate which warms up whatever caches it likes,
+ * and reports progress through diagnostic messages.
+ */
+class Preloader {
+    // Types
+public:
+    /**
+     * These are the possible outcomes of handing a file to the delegate.
+     */
+    enum class Result {
+        /**
+         * The file was loaded.
+         */
+        Loaded,
+
+        /**
+         * The file was skipped.
+         */
+        Skipped,
+
+        /**
+         * The file was skipped, and no more files should be loaded.
+         */
+        Stop,
+    };
+
+    /**
+     * This is the type of function called for each file found.
+     *
+     * @param[in] path
+     *     This is the path of the file.
+     *
+     * @param[in] fileInfo
+     *     This is the metadata of the file.
+     *
+     * @return
+     *     The outcome of loading the file is returned.
+     */
+    typedef std::function<
+        Result(
+            const std::string& path,
+            const FileInfo& fileInfo
+        )
+    > LoadDelegate;
+
+    // Lifecycle Methods
+public:
+    ~Preloader() noexcept;
+    Preloader(const Preloader&) = delete;
+    Preloader(Preloader&&) noexcept = delete;
+    Preloader& operator=(const Preloader&) = delete;
+    Preloader& operator=(Preloader&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     *
+     * @param[in] diagnosticMessageDelegate
+     *     This is the function to call to publish any diagnostic messages.
+     */
+    explicit Preloader(
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
+    );
+
+    /**
+     * This method starts walking the given directory tree
+     * on a worker thread.
+     *
+     * @param[in] root
+     *     This is the path of the directory at the root of the tree.
+     *
+     * @param[in] loadDelegate
+     *     This is the function to call, from the worker thread,
+     *     for each file found in the tree.
+     */
+    void Start(
+        const std::string& root,
+        LoadDelegate loadDelegate
+    );
+
+    /**
+     * This method stops walking the directory tree, if it hasn't
+     * finished already, and waits for the worker thread to exit.
+     */
+    void Stop();
+
+    /**
+     * This method returns an indication of whether or not the worker
+     * thread has finished walking the directory tree.
+     *
+     * @return
+     *     An indication of whether or not the directory tree
+     *     has been walked is returned.
+     */
+    bool IsFinished() const;
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* STATIC_CONTENT_PLUGIN_PRELOADER_HPP */
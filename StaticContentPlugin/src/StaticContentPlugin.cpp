@@ -7,13 +7,33 @@
  * © 2018 by Richard Walters
  */
 
+#include "AssetArchive.hpp"
+#include "ByteRanges.hpp"
+#include "Compression.hpp"
+#include "CompressionQueue.hpp"
+#include "ContentCache.hpp"
+#include "ContentStore.hpp"
+#include "FileInfo.hpp"
+#include "FileMapping.hpp"
+#include "Glob.hpp"
+#include "HttpDate.hpp"
+#include "MimeTypes.hpp"
+#include "NotFoundCache.hpp"
+#include "PathIndex.hpp"
+#include "Preloader.hpp"
+#include "TreeMonitor.hpp"
+
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <Hash/Sha1.hpp>
 #include <Http/Server.hpp>
 #include <inttypes.h>
 #include <Json/Value.hpp>
+#include <map>
+#include <random>
 #include <regex>
-#include <Hash/Sha1.hpp>
-#include <Hash/Templates.hpp>
+#include <string.h>
 #include <StringExtensions/StringExtensions.hpp>
 #include <SystemAbstractions/File.hpp>
 #include <WebServer/PluginEntryPoint.hpp>
@@ -24,88 +44,2503 @@
 #define API
 #endif /* _WIN32 / POSIX */
 
-namespace {
+namespace {
+
+    /**
+     * This is the default maximum number of bytes of file content and
+     * metadata to cache in memory for each space.
+     */
+    constexpr size_t DEFAULT_CACHE_SIZE = 16 * 1024 * 1024;
+
+    /**
+     * This is the maximum number of byte ranges a single request may ask
+     * for.  Requests for more ranges are served the whole resource instead,
+     * to keep clients from making us do lots of work for little data.
+     */
+    constexpr size_t MAX_BYTE_RANGES = 16;
+
+    /**
+     * This is the content type given to files whose extensions
+     * aren't recognized.
+     */
+    constexpr const char* DEFAULT_CONTENT_TYPE = "application/octet-stream";
+
+    /**
+     * This is the default size, in bytes, of the largest files to read,
+     * hash and compress when preloading a space.
+     */
+    constexpr uint64_t DEFAULT_PRELOAD_MAX_FILE_SIZE = 1024 * 1024;
+
+    /**
+     * This is the default maximum number of paths to remember as missing
+     * for each space whose root is watched for changes.
+     */
+    constexpr size_t DEFAULT_NOT_FOUND_CACHE_SIZE = 1024;
+
+    /**
+     * This is the default name of the file served in place
+     * of a directory.
+     */
+    constexpr const char* DEFAULT_INDEX_FILE = "index.html";
+
+    /**
+     * This is the default number of threads used to compress files
+     * in the background, for each space which does so.
+     */
+    constexpr size_t DEFAULT_BACKGROUND_COMPRESSION_THREADS = 1;
+
+    /**
+     * This is the default largest share of processor time which each
+     * thread compressing files in the background may use.
+     */
+    constexpr double DEFAULT_BACKGROUND_COMPRESSION_MAX_CPU_SHARE = 0.5;
+
+    /**
+     * This is the largest number of files which may be waiting to be
+     * compressed in the background, for each space which does so.
+     */
+    constexpr size_t MAX_BACKGROUND_COMPRESSION_JOBS = 1024;
+
+    /**
+     * These are the settings used to compress files quickly in the
+     * background, the first time they're called for.
+     */
+    constexpr int FAST_GZIP_LEVEL = 1;
+    constexpr int FAST_BROTLI_QUALITY = 1;
+
+    /**
+     * These are the settings used to compress files again in the
+     * background, as tightly as possible, when there's time.
+     */
+    constexpr int BEST_GZIP_LEVEL = 9;
+    constexpr int BEST_BROTLI_QUALITY = 11;
+
+    /**
+     * This describes one kind of precompressed "sidecar" file which may
+     * be found next to a file, holding an encoded variant of it.
+     */
+    struct SidecarType {
+        /**
+         * This is the name of the content coding of the sidecar file.
+         */
+        const char* coding;
+
+        /**
+         * This is the extension appended to the path of a file
+         * to form the path of its sidecar file.
+         */
+        const char* extension;
+    };
+
+    /**
+     * These are the kinds of sidecar files recognized,
+     * in order of preference.
+     */
+    constexpr SidecarType SIDECARS[] = {
+        {"br", ".br"},
+        {"gzip", ".gz"},
+    };
+
+    /**
+     * This describes the content type configured for files in a space
+     * having a particular extension.
+     */
+    struct ConfiguredMimeType {
+        /**
+         * This is the value to give in the "Content-Type" header
+         * for files with the extension.
+         */
+        std::string contentType;
+
+        /**
+         * This indicates whether or not files of this type benefit
+         * from being compressed.
+         */
+        bool compressible = false;
+    };
+
+    /**
+     * This holds the caching policy for files in a space whose
+     * paths match a particular pattern.
+     */
+    struct CacheControlOverride {
+        /**
+         * This is the pattern which paths of files must match
+         * for the policy to apply to them.  If the pattern has no
+         * "/" in it, it's matched against the name of each file
+         * rather than its path.
+         */
+        std::string pattern;
+
+        /**
+         * This is the value of the "Cache-Control" header to send
+         * with files matching the pattern, or an empty string if
+         * no "Cache-Control" header should be sent.
+         */
+        std::string cacheControl;
+    };
+
+    /**
+     * This represents one space of server resources and how they
+     * should be mapped to the file system.
+     */
+    struct SpaceMapping {
+        /**
+         * This is the path to the resource space in the server.
+         */
+        std::vector< std::string > space;
+
+        /**
+         * This is the file system path to the files to be served,
+         * or the path of the archive holding them, if the space is
+         * served from an archive.
+         */
+        std::string root;
+
+        /**
+         * If the space is served from an archive, rather than from
+         * a directory, this is the archive.
+         */
+        std::shared_ptr< const AssetArchive > archive;
+
+        /**
+         * This holds the contents and metadata of recently
+         * served files from the space.
+         */
+        std::shared_ptr< ContentCache > cache;
+
+        /**
+         * If not empty, this is the path, relative to the root of the
+         * space, at which to serve the statistics of the cache,
+         * rather than a file.
+         */
+        std::string statisticsPath;
+
+        /**
+         * If not empty, this is the name of the file to serve in place of
+         * a directory, such as "index.html".  Requests for directories
+         * with such a file, which don't end in a slash, are redirected
+         * to the same path with a slash.
+         */
+        std::string indexFile = DEFAULT_INDEX_FILE;
+
+        /**
+         * This indicates whether or not the contents of files in the
+         * space, and encoded variants of them, are deduplicated with
+         * identical contents held in memory for other spaces.
+         */
+        bool deduplicate = true;
+
+        /**
+         * If contents are deduplicated, this is used to find the
+         * identical contents already held in memory.
+         */
+        std::shared_ptr< ContentStore > contentStore;
+
+        /**
+         * This indicates whether or not entity tags are derived cheaply
+         * from file metadata (weak tags) rather than from file contents
+         * (strong tags).
+         */
+        bool weakEntityTags = false;
+
+        /**
+         * These are the settings which control how resources
+         * in the space are compressed.
+         */
+        CompressionSettings compression;
+
+        /**
+         * This indicates whether or not to look for precompressed
+         * sidecar files next to files being served.
+         */
+        bool precompressed = true;
+
+        /**
+         * If files are compressed in the background, rather than while
+         * handling the requests which call for them, this runs the
+         * compression jobs.
+         */
+        std::shared_ptr< CompressionQueue > compressionQueue;
+
+        /**
+         * This is the smallest size, in bytes, of files to map into
+         * memory rather than read.
+         */
+        uint64_t mappingMinSize = 0;
+
+        /**
+         * This is the largest size, in bytes, of files to map into
+         * memory rather than read.  If zero, files are never mapped.
+         */
+        uint64_t mappingMaxSize = 0;
+
+        /**
+         * This is the function to call to deliver diagnostic
+         * messages generated by the plug-in.
+         */
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate;
+
+        /**
+         * If the root of the space is being watched for changes, this
+         * watches it, clearing the cache whenever anything changes, so
+         * that cached files can be served without checking whether or
+         * not they have changed.
+         */
+        std::shared_ptr< TreeMonitor > monitor;
+
+        /**
+         * If the root of the space is being watched for changes, this
+         * indicates whether or not every directory in the space is
+         * being watched.  If not, changes may go unnoticed, so the
+         * file system is consulted as if the space weren't watched.
+         */
+        std::shared_ptr< std::atomic< bool > > isWatched;
+
+        /**
+         * If the root of the space is being watched for changes, this
+         * remembers which paths were recently found not to exist, so that
+         * requests for them are turned away without checking the file
+         * system again.
+         */
+        std::shared_ptr< NotFoundCache > notFoundCache;
+
+        /**
+         * If the root of the space is being watched for changes, this
+         * optionally holds an index of all the files in the space, used
+         * to resolve requests to files without consulting the file system.
+         */
+        std::shared_ptr< PathIndex > pathIndex;
+
+        /**
+         * This is the response given to requests for resources which
+         * don't exist, which is made ahead of time.
+         */
+        std::shared_ptr< const Http::Response > notFoundResponse;
+
+        /**
+         * If the space is to be preloaded, this walks the root of the
+         * space on a worker thread when the plug-in is loaded, warming up
+         * the cache.
+         */
+        std::shared_ptr< Preloader > preloader;
+
+        /**
+         * This is the size, in bytes, of the largest files to read, hash
+         * and compress when preloading the space.  Larger files are
+         * preloaded only if their entity tags don't require reading them.
+         */
+        uint64_t preloadMaxFileSize = DEFAULT_PRELOAD_MAX_FILE_SIZE;
+
+        /**
+         * These are the content types configured for the space, keyed by
+         * lower-case file name extension, which take precedence over
+         * the built-in MIME types.
+         */
+        std::map< std::string, ConfiguredMimeType > mimeTypes;
+
+        /**
+         * This is the value of the "Cache-Control" header to send with
+         * files which don't match any of the caching policy overrides,
+         * or an empty string if no "Cache-Control" header should be sent.
+         */
+        std::string cacheControl;
+
+        /**
+         * These are the caching policies which apply to files matching
+         * particular patterns, in order of precedence.
+         */
+        std::vector< CacheControlOverride > cacheControlOverrides;
+
+        /**
+         * This is the function to call in order to unregister
+         * the plug-in as handling this server resource space.
+         */
+        Http::IServer::UnregistrationDelegate unregistrationDelegate;
+    };
+
+    /**
+     * This function sets the "Content-Length" header of the given
+     * response to match the length of its body.
+     *
+     * @param[in,out] response
+     *     This is the response to finish.
+     */
+    void SetContentLength(Http::Response& response) {
+        response.headers.SetHeader("Content-Length", StringExtensions::sprintf("%zu", response.body.length()));
+    }
+
+    /**
+     * This function forms the value of a "Cache-Control" header
+     * from the given caching policy configuration.
+     *
+     * @param[in] policy
+     *     This holds the items of the caching policy.
+     *
+     * @return
+     *     The value of the "Cache-Control" header for the policy
+     *     is returned.  If the policy calls for no directives at all,
+     *     an empty string is returned.
+     */
+    std::string MakeCacheControl(const Json::Value& policy) {
+        std::vector< std::string > directives;
+        const auto noCacheJson = policy["noCache"];
+        if (
+            (noCacheJson.GetType() == Json::Value::Type::Boolean)
+            && (bool)noCacheJson
+        ) {
+            directives.push_back("no-cache");
+        }
+        const auto maxAgeJson = policy["maxAge"];
+        if (
+            (maxAgeJson.GetType() == Json::Value::Type::Integer)
+            || (maxAgeJson.GetType() == Json::Value::Type::FloatingPoint)
+        ) {
+            directives.push_back(
+                StringExtensions::sprintf(
+                    "max-age=%" PRIu64,
+                    (uint64_t)std::max((double)maxAgeJson, 0.0)
+                )
+            );
+        }
+        const auto immutableJson = policy["immutable"];
+        if (
+            (immutableJson.GetType() == Json::Value::Type::Boolean)
+            && (bool)immutableJson
+        ) {
+            directives.push_back("immutable");
+        }
+        return StringExtensions::Join(directives, ", ");
+    }
+
+    /**
+     * This function configures the given space mapping from
+     * the given configuration items.
+     *
+     * @param[in,out] spaceMapping
+     *     This is the space mapping to configure.
+     *
+     * @parma[in] configuration
+     *     This contains the items used to configure the space mapping.
+     *
+     * @param[in] diagnosticMessageDelegate
+     *     This is the function to call to deliver diagnostic
+     *     messages generated by the plug-in.
+     *
+     * @return
+     *     An indication of whether or not the space mapping
+     *     was successfully configured is returned.
+     */
+    bool ConfigureSpaceMapping(
+        SpaceMapping& spaceMapping,
+        Json::Value configuration,
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
+    ) {
+        // Determine the resource space we're serving.
+        Uri::Uri uri;
+        if (!configuration.Has("space")) {
+            diagnosticMessageDelegate(
+                "",
+                SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                "no 'space' URI in configuration"
+            );
+            return false;
+        }
+        if (!uri.ParseFromString(configuration["space"])) {
+            diagnosticMessageDelegate(
+                "",
+                SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                "unable to parse 'space' URI in configuration"
+            );
+            return false;
+        }
+        spaceMapping.space = uri.GetPath();
+        (void)spaceMapping.space.erase(spaceMapping.space.begin());
+
+        // Determine where to locate the static content.
+        const auto isArchived = configuration.Has("archive");
+        if (
+            !isArchived
+            && !configuration.Has("root")
+        ) {
+            diagnosticMessageDelegate(
+                "",
+                SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                "no 'root' URI in configuration"
+            );
+            return false;
+        }
+        spaceMapping.root = (std::string)configuration[isArchived ? "archive" : "root"];
+        if (!SystemAbstractions::File::IsAbsolutePath(spaceMapping.root)) {
+            spaceMapping.root = SystemAbstractions::File::GetExeParentDirectory() + "/" + spaceMapping.root;
+        }
+        if (isArchived) {
+            spaceMapping.archive = AssetArchive::Open(
+                spaceMapping.root,
+                diagnosticMessageDelegate
+            );
+            if (spaceMapping.archive == nullptr) {
+                return false;
+            }
+        }
+
+        // Determine how much memory to use for caching files.
+        size_t cacheSize = DEFAULT_CACHE_SIZE;
+        const auto cacheSizeJson = configuration["cacheSize"];
+        if (
+            (cacheSizeJson.GetType() == Json::Value::Type::Integer)
+            || (cacheSizeJson.GetType() == Json::Value::Type::FloatingPoint)
+        ) {
+            const auto cacheSizeValue = (double)cacheSizeJson;
+            cacheSize = (
+                (cacheSizeValue > 0.0)
+                ? (size_t)cacheSizeValue
+                : 0
+            );
+        }
+        auto cachePolicy = ContentCache::EvictionPolicy::Lru;
+        const auto cachePolicyJson = configuration["cachePolicy"];
+        if (cachePolicyJson.GetType() == Json::Value::Type::String) {
+            const auto cachePolicyName = (std::string)cachePolicyJson;
+            if (cachePolicyName == "w-tinylfu") {
+                cachePolicy = ContentCache::EvictionPolicy::WTinyLfu;
+            } else if (cachePolicyName != "lru") {
+                diagnosticMessageDelegate(
+                    "",
+                    SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                    StringExtensions::sprintf(
+                        "unrecognized 'cachePolicy' '%s' in configuration",
+                        cachePolicyName.c_str()
+                    )
+                );
+                return false;
+            }
+        }
+        spaceMapping.cache = std::make_shared< ContentCache >(cacheSize, cachePolicy);
+        const auto statisticsPathJson = configuration["statsPath"];
+        if (statisticsPathJson.GetType() == Json::Value::Type::String) {
+            spaceMapping.statisticsPath = (std::string)statisticsPathJson;
+        }
+        const auto indexFileJson = configuration["indexFile"];
+        if (indexFileJson.GetType() == Json::Value::Type::String) {
+            spaceMapping.indexFile = (std::string)indexFileJson;
+        }
+        const auto deduplicateJson = configuration["deduplicate"];
+        if (deduplicateJson.GetType() == Json::Value::Type::Boolean) {
+            spaceMapping.deduplicate = deduplicateJson;
+        }
+
+        // Determine how to compute entity tags.
+        const auto entityTagsJson = configuration["entityTags"];
+        if (entityTagsJson.GetType() == Json::Value::Type::String) {
+            const auto entityTags = (std::string)entityTagsJson;
+            if (entityTags == "weak") {
+                spaceMapping.weakEntityTags = true;
+            } else if (entityTags != "strong") {
+                diagnosticMessageDelegate(
+                    "",
+                    SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                    StringExtensions::sprintf(
+                        "unrecognized 'entityTags' mode '%s' in configuration",
+                        entityTags.c_str()
+                    )
+                );
+                return false;
+            }
+        }
+
+        // Determine how to compress resources.
+        const auto compressionJson = configuration["compression"];
+        const auto codingsJson = compressionJson["codings"];
+        if (codingsJson.GetType() == Json::Value::Type::Array) {
+            for (size_t i = 0; i < codingsJson.GetSize(); ++i) {
+                const auto coding = (std::string)codingsJson[i];
+                if (IsContentCodingSupported(coding)) {
+                    spaceMapping.compression.codings.push_back(coding);
+                } else {
+                    diagnosticMessageDelegate(
+                        "",
+                        SystemAbstractions::DiagnosticsSender::Levels::WARNING,
+                        StringExtensions::sprintf(
+                            "content coding '%s' is not supported; ignoring",
+                            coding.c_str()
+                        )
+                    );
+                }
+            }
+        } else {
+            for (const auto coding: {"br", "gzip"}) {
+                if (IsContentCodingSupported(coding)) {
+                    spaceMapping.compression.codings.push_back(coding);
+                }
+            }
+        }
+        const auto mmapJson = configuration["mmap"];
+        if (mmapJson.GetType() == Json::Value::Type::Object) {
+            const auto minSizeJson = mmapJson["minSize"];
+            if (
+                (minSizeJson.GetType() == Json::Value::Type::Integer)
+                || (minSizeJson.GetType() == Json::Value::Type::FloatingPoint)
+            ) {
+                spaceMapping.mappingMinSize = (uint64_t)std::max((double)minSizeJson, 0.0);
+            }
+            const auto maxSizeJson = mmapJson["maxSize"];
+            if (
+                (maxSizeJson.GetType() == Json::Value::Type::Integer)
+                || (maxSizeJson.GetType() == Json::Value::Type::FloatingPoint)
+            ) {
+                spaceMapping.mappingMaxSize = (uint64_t)std::max((double)maxSizeJson, 0.0);
+            }
+        }
+        spaceMapping.diagnosticMessageDelegate = diagnosticMessageDelegate;
+        const auto precompressedJson = configuration["precompressed"];
+        if (precompressedJson.GetType() == Json::Value::Type::Boolean) {
+            spaceMapping.precompressed = precompressedJson;
+        }
+        const auto gzipLevelJson = compressionJson["gzipLevel"];
+        if (gzipLevelJson.GetType() == Json::Value::Type::Integer) {
+            spaceMapping.compression.gzipLevel = std::min(std::max((int)gzipLevelJson, 1), 9);
+        }
+        const auto brotliQualityJson = compressionJson["brotliQuality"];
+        if (brotliQualityJson.GetType() == Json::Value::Type::Integer) {
+            spaceMapping.compression.brotliQuality = std::min(std::max((int)brotliQualityJson, 0), 11);
+        }
+        const auto backgroundJson = compressionJson["background"];
+        if (
+            (backgroundJson.GetType() == Json::Value::Type::Object)
+            || (
+                (backgroundJson.GetType() == Json::Value::Type::Boolean)
+                && (bool)backgroundJson
+            )
+        ) {
+            size_t backgroundThreads = DEFAULT_BACKGROUND_COMPRESSION_THREADS;
+            const auto backgroundThreadsJson = backgroundJson["threads"];
+            if (backgroundThreadsJson.GetType() == Json::Value::Type::Integer) {
+                backgroundThreads = (size_t)std::max((int)backgroundThreadsJson, 1);
+            }
+            auto maxCpuShare = DEFAULT_BACKGROUND_COMPRESSION_MAX_CPU_SHARE;
+            const auto maxCpuShareJson = backgroundJson["maxCpuShare"];
+            if (
+                (maxCpuShareJson.GetType() == Json::Value::Type::Integer)
+                || (maxCpuShareJson.GetType() == Json::Value::Type::FloatingPoint)
+            ) {
+                maxCpuShare = (double)maxCpuShareJson;
+            }
+            spaceMapping.compressionQueue = std::make_shared< CompressionQueue >(
+                backgroundThreads,
+                maxCpuShare,
+                MAX_BACKGROUND_COMPRESSION_JOBS
+            );
+        }
+
+        // Determine what caching policies to give clients.
+        const auto cacheControlJson = configuration["cacheControl"];
+        if (cacheControlJson.GetType() == Json::Value::Type::Object) {
+            spaceMapping.cacheControl = MakeCacheControl(cacheControlJson);
+            const auto overridesJson = cacheControlJson["overrides"];
+            for (size_t i = 0; i < overridesJson.GetSize(); ++i) {
+                const auto overrideJson = overridesJson[i];
+                if (overrideJson["pattern"].GetType() != Json::Value::Type::String) {
+                    diagnosticMessageDelegate(
+                        "",
+                        SystemAbstractions::DiagnosticsSender::Levels::WARNING,
+                        "'cacheControl' override has no 'pattern'; ignoring"
+                    );
+                    continue;
+                }
+                CacheControlOverride cacheControlOverride;
+                cacheControlOverride.pattern = (std::string)overrideJson["pattern"];
+                cacheControlOverride.cacheControl = MakeCacheControl(overrideJson);
+                spaceMapping.cacheControlOverrides.push_back(cacheControlOverride);
+            }
+        }
+
+        // Determine whether or not to watch for changes to files,
+        // rather than checking for them on every request.
+        // Archives don't change while they're open, so there's nothing
+        // to watch or to preload.
+        const auto watchJson = configuration["watch"];
+        if (
+            !isArchived
+            && (watchJson.GetType() == Json::Value::Type::Boolean)
+            && (bool)watchJson
+        ) {
+            spaceMapping.monitor = std::make_shared< TreeMonitor >(diagnosticMessageDelegate);
+            size_t notFoundCacheSize = DEFAULT_NOT_FOUND_CACHE_SIZE;
+            const auto notFoundJson = configuration["notFound"];
+            const auto notFoundCacheSizeJson = notFoundJson["cacheSize"];
+            if (
+                (notFoundCacheSizeJson.GetType() == Json::Value::Type::Integer)
+                || (notFoundCacheSizeJson.GetType() == Json::Value::Type::FloatingPoint)
+            ) {
+                notFoundCacheSize = (size_t)std::max((double)notFoundCacheSizeJson, 0.0);
+            }
+            const auto notFoundFilterJson = notFoundJson["filter"];
+            const auto notFoundFilter = (
+                (notFoundFilterJson.GetType() == Json::Value::Type::Boolean)
+                && (bool)notFoundFilterJson
+            );
+            if (
+                (notFoundCacheSize > 0)
+                || notFoundFilter
+            ) {
+                spaceMapping.notFoundCache = std::make_shared< NotFoundCache >(
+                    notFoundCacheSize,
+                    notFoundFilter
+                );
+            }
+            const auto pathIndexJson = configuration["pathIndex"];
+            if (
+                (pathIndexJson.GetType() == Json::Value::Type::Boolean)
+                && (bool)pathIndexJson
+            ) {
+                spaceMapping.pathIndex = std::make_shared< PathIndex >(spaceMapping.root);
+            }
+        }
+
+        // Determine whether or not to warm up the cache when loaded.
+        const auto preloadJson = configuration["preload"];
+        if (
+            !isArchived
+            && (
+                (
+                    (preloadJson.GetType() == Json::Value::Type::Boolean)
+                    && (bool)preloadJson
+                )
+                || (preloadJson.GetType() == Json::Value::Type::Object)
+            )
+        ) {
+            spaceMapping.preloader = std::make_shared< Preloader >(diagnosticMessageDelegate);
+            const auto maxFileSizeJson = preloadJson["maxFileSize"];
+            if (
+                (maxFileSizeJson.GetType() == Json::Value::Type::Integer)
+                || (maxFileSizeJson.GetType() == Json::Value::Type::FloatingPoint)
+            ) {
+                spaceMapping.preloadMaxFileSize = (uint64_t)std::max((double)maxFileSizeJson, 0.0);
+            }
+        }
+
+        // Determine any additional content types to recognize.
+        const auto mimeTypesJson = configuration["mimeTypes"];
+        if (mimeTypesJson.GetType() == Json::Value::Type::Object) {
+            for (const auto& key: mimeTypesJson.GetKeys()) {
+                auto extension = StringExtensions::ToLower(key);
+                if (
+                    !extension.empty()
+                    && (extension[0] == '.')
+                ) {
+                    (void)extension.erase(extension.begin());
+                }
+                const auto mimeTypeJson = mimeTypesJson[key];
+                ConfiguredMimeType mimeType;
+                if (mimeTypeJson.GetType() == Json::Value::Type::String) {
+                    mimeType.contentType = (std::string)mimeTypeJson;
+                    mimeType.compressible = (mimeType.contentType.compare(0, 5, "text/") == 0);
+                } else if (mimeTypeJson["type"].GetType() == Json::Value::Type::String) {
+                    mimeType.contentType = (std::string)mimeTypeJson["type"];
+                    mimeType.compressible = (bool)mimeTypeJson["compressible"];
+                } else {
+                    diagnosticMessageDelegate(
+                        "",
+                        SystemAbstractions::DiagnosticsSender::Levels::WARNING,
+                        StringExtensions::sprintf(
+                            "no content type given for extension '%s'; ignoring",
+                            key.c_str()
+                        )
+                    );
+                    continue;
+                }
+                spaceMapping.mimeTypes[extension] = mimeType;
+            }
+        }
+
+        // Make the response to give for resources which don't exist.
+        // It doesn't mention the path requested, so that it can be
+        // made just once, and so that it doesn't reveal where files
+        // are kept.
+        const auto notFoundResponse = std::make_shared< Http::Response >();
+        notFoundResponse->statusCode = 404;
+        notFoundResponse->reasonPhrase = "Not Found";
+        notFoundResponse->headers.AddHeader("Content-Type", "text/plain");
+        notFoundResponse->body = "Not found.";
+        SetContentLength(*notFoundResponse);
+        spaceMapping.notFoundResponse = notFoundResponse;
+        return true;
+    }
+
+    /**
+     * This function determines the content type of the file
+     * at the given path, based on its extension.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the file.
+     *
+     * @param[in] path
+     *     This is the path of the file whose content type is needed.
+     *
+     * @param[out] contentType
+     *     This is where to store the content type of the file.
+     *
+     * @param[out] isWorthyOfBeingGzipped
+     *     This is where to store an indication of whether or not
+     *     the file is of a type which benefits from being compressed.
+     */
+    void DetermineContentType(
+        const SpaceMapping& spaceMapping,
+        const std::string& path,
+        std::string& contentType,
+        bool& isWorthyOfBeingGzipped
+    ) {
+        const auto delimiter = path.find_last_of("/.");
+        if (
+            (delimiter == std::string::npos)
+            || (path[delimiter] != '.')
+        ) {
+            contentType = DEFAULT_CONTENT_TYPE;
+            isWorthyOfBeingGzipped = false;
+            return;
+        }
+        const auto extension = path.c_str() + delimiter + 1;
+        const auto extensionLength = path.length() - delimiter - 1;
+        if (!spaceMapping.mimeTypes.empty()) {
+            const auto configuredMimeType = spaceMapping.mimeTypes.find(
+                StringExtensions::ToLower(std::string(extension, extensionLength))
+            );
+            if (configuredMimeType != spaceMapping.mimeTypes.end()) {
+                contentType = configuredMimeType->second.contentType;
+                isWorthyOfBeingGzipped = configuredMimeType->second.compressible;
+                return;
+            }
+        }
+        const auto mimeType = FindMimeType(extension, extensionLength);
+        if (mimeType == nullptr) {
+            contentType = DEFAULT_CONTENT_TYPE;
+            isWorthyOfBeingGzipped = false;
+        } else {
+            contentType = mimeType->contentType;
+            isWorthyOfBeingGzipped = mimeType->compressible;
+        }
+    }
+
+    /**
+     * This function reads the contents of the file at the given path.
+     *
+     * @param[in] path
+     *     This is the path of the file to read.
+     *
+     * @param[in] fileInfo
+     *     This is the metadata of the file, looked up just before
+     *     reading it.
+     *
+     * @param[out] content
+     *     This is where to store the contents of the file.
+     *
+     * @param[out] response
+     *     This is where to store the error response if the file
+     *     could not be read.
+     *
+     * @return
+     *     An indication of whether or not the file was read
+     *     successfully is returned.
+     */
+    bool ReadFile(
+        const std::string& path,
+        const FileInfo& fileInfo,
+        std::shared_ptr< const std::string >& content,
+        Http::Response& response
+    ) {
+        SystemAbstractions::File file(path);
+        if (!file.OpenReadOnly()) {
+            response.statusCode = 500;
+            response.reasonPhrase = "Unable to open file";
+            response.headers.AddHeader("Content-Type", "text/plain");
+            response.body = StringExtensions::sprintf(
+                "Error opening file '%s'",
+                path.c_str()
+            );
+            return false;
+        }
+        const auto buffer = std::make_shared< std::string >((size_t)fileInfo.size, '\0');
+        if (
+            !buffer->empty()
+            && (file.Read(&(*buffer)[0], buffer->length()) != buffer->length())
+        ) {
+            response.statusCode = 500;
+            response.reasonPhrase = "Unable to read file";
+            response.headers.AddHeader("Content-Type", "text/plain");
+            response.body = StringExtensions::sprintf(
+                "Error reading file '%s'",
+                path.c_str()
+            );
+            return false;
+        }
+        content = buffer;
+        return true;
+    }
+
+    /**
+     * This function returns the copy of the given contents to hold
+     * in memory, which is any identical copy already held in memory,
+     * if contents are deduplicated.
+     *
+     * @param[in] contentStore
+     *     This is used to find identical contents already held
+     *     in memory.  If nullptr, contents aren't deduplicated.
+     *
+     * @param[in] content
+     *     These are the contents to deduplicate.
+     *
+     * @return
+     *     The copy of the contents to hold in memory is returned.
+     */
+    std::shared_ptr< const std::string > Deduplicate(
+        const std::shared_ptr< ContentStore >& contentStore,
+        std::shared_ptr< const std::string > content
+    ) {
+        if (contentStore == nullptr) {
+            return content;
+        }
+        return contentStore->Intern(std::move(content));
+    }
+
+    /**
+     * This function computes a strong entity tag for the given contents
+     * of a file: the hexadecimal SHA-1 digest of the contents, which are
+     * hashed where they are rather than copied first.
+     *
+     * @param[in] data
+     *     This points to the contents of the file.
+     *
+     * @param[in] size
+     *     This is the size of the contents of the file, in bytes.
+     *
+     * @return
+     *     The strong entity tag for the file is returned.
+     */
+    std::string MakeStrongEntityTag(
+        const void* data,
+        size_t size
+    ) {
+        const auto digest = Hash::Sha1((const uint8_t*)data, size);
+        std::string entityTag;
+        entityTag.reserve(digest.size() * 2);
+        for (const auto byte: digest) {
+            entityTag += StringExtensions::sprintf("%02x", byte);
+        }
+        return entityTag;
+    }
+
+    /**
+     * This function computes a weak entity tag for the given version
+     * of a file, from its metadata alone.
+     *
+     * @param[in] fileInfo
+     *     This is the metadata of the file.
+     *
+     * @return
+     *     The weak entity tag for the file is returned.
+     */
+    std::string MakeWeakEntityTag(const FileInfo& fileInfo) {
+        return StringExtensions::sprintf(
+            "W/\"%" PRIx64 "-%" PRIx64 "-%" PRIx64 ".%" PRIx32 "\"",
+            fileInfo.inode,
+            fileInfo.size,
+            (uint64_t)fileInfo.lastModifiedTime,
+            fileInfo.lastModifiedTimeNanoseconds
+        );
+    }
+
+    /**
+     * This function derives the entity tag of an encoded variant of
+     * a resource from the entity tag of the resource itself.
+     *
+     * @param[in] entityTag
+     *     This is the entity tag of the resource.
+     *
+     * @param[in] coding
+     *     This is the name of the content coding of the variant.
+     *
+     * @return
+     *     The entity tag of the variant is returned.
+     */
+    std::string MakeVariantEntityTag(
+        const std::string& entityTag,
+        const std::string& coding
+    ) {
+        if (
+            !entityTag.empty()
+            && (entityTag.back() == '"')
+        ) {
+            return entityTag.substr(0, entityTag.length() - 1) + "-" + coding + "\"";
+        } else {
+            return entityTag + "-" + coding;
+        }
+    }
+
+    /**
+     * This function determines whether or not the given entity tag
+     * matches the given entity tag from a request, using the "weak"
+     * comparison function appropriate for "If-None-Match".
+     *
+     * @param[in] requestEntityTag
+     *     This is the entity tag given in the request.
+     *
+     * @param[in] entityTag
+     *     This is the current entity tag of the resource.
+     *
+     * @return
+     *     An indication of whether or not the entity tags
+     *     match is returned.
+     */
+    bool EntityTagMatches(
+        const std::string& requestEntityTag,
+        const std::string& entityTag
+    ) {
+        const auto opaqueTag = [](const std::string& tag){
+            if (tag.compare(0, 2, "W/") == 0) {
+                return tag.substr(2);
+            } else {
+                return tag;
+            }
+        };
+        return (opaqueTag(requestEntityTag) == opaqueTag(entityTag));
+    }
+
+    /**
+     * This function determines whether or not the conditional headers
+     * of the given request ("If-None-Match", or "If-Modified-Since" in
+     * its absence) indicate that the client's copy of the resource
+     * is still current, according to RFC 7232.
+     *
+     * @param[in] request
+     *     This is the request for the resource.
+     *
+     * @param[in] entityTag
+     *     This is the current entity tag of the resource.
+     *
+     * @param[in] fileInfo
+     *     This holds the metadata of the file providing the resource.
+     *
+     * @return
+     *     An indication of whether or not the resource is unmodified
+     *     is returned.
+     */
+    bool IsNotModified(
+        const Http::Request& request,
+        const std::string& entityTag,
+        const FileInfo& fileInfo
+    ) {
+        if (request.headers.HasHeader("If-None-Match")) {
+            const auto ifNoneMatch = StringExtensions::Trim(
+                request.headers.GetHeaderValue("If-None-Match")
+            );
+            if (ifNoneMatch == "*") {
+                return true;
+            }
+            for (const auto& requestEntityTag: StringExtensions::Split(ifNoneMatch, ',')) {
+                if (EntityTagMatches(StringExtensions::Trim(requestEntityTag), entityTag)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        if (request.headers.HasHeader("If-Modified-Since")) {
+            int64_t ifModifiedSince;
+            return (
+                ParseHttpDate(
+                    request.headers.GetHeaderValue("If-Modified-Since"),
+                    ifModifiedSince
+                )
+                && (fileInfo.lastModifiedTime <= ifModifiedSince)
+            );
+        }
+        return false;
+    }
+
+    /**
+     * This function adds the given entry to the given cache.  If the entry
+     * is too large to be cached, the metadata of the entry is cached
+     * without the file contents, so that entity tags are still memoized.
+     *
+     * @param[in,out] cache
+     *     This is the cache to which to add the entry.
+     *
+     * @param[in] entry
+     *     This is the entry to add to the cache.
+     */
+    void CacheEntry(
+        ContentCache& cache,
+        const std::shared_ptr< const ContentCache::Entry >& entry
+    ) {
+        if (
+            !cache.Insert(entry)
+            && (entry->content != nullptr)
+        ) {
+            const auto metadataOnlyEntry = std::make_shared< ContentCache::Entry >(*entry);
+            metadataOnlyEntry->content = nullptr;
+            (void)cache.Insert(metadataOnlyEntry);
+        }
+    }
+
+    /**
+     * This function determines whether or not a file of the given size
+     * should be mapped into memory rather than read.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the file.
+     *
+     * @param[in] size
+     *     This is the size of the file, in bytes.
+     *
+     * @return
+     *     An indication of whether or not the file
+     *     should be mapped is returned.
+     */
+    bool IsMappable(
+        const SpaceMapping& spaceMapping,
+        uint64_t size
+    ) {
+        return (
+            (size > 0)
+            && (size >= spaceMapping.mappingMinSize)
+            && (size <= spaceMapping.mappingMaxSize)
+        );
+    }
+
+    /**
+     * This function returns the value of the "Cache-Control" header to
+     * send with the file at the given path within the given space.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the file.
+     *
+     * @param[in] relativePath
+     *     This is the path of the file, relative to the root of the space.
+     *
+     * @return
+     *     The value of the "Cache-Control" header for the file is
+     *     returned.  If no "Cache-Control" header should be sent,
+     *     an empty string is returned.
+     */
+    const std::string& GetCacheControl(
+        const SpaceMapping& spaceMapping,
+        const std::string& relativePath
+    ) {
+        const auto lastDelimiter = relativePath.find_last_of('/');
+        const auto name = (
+            (lastDelimiter == std::string::npos)
+            ? relativePath
+            : relativePath.substr(lastDelimiter + 1)
+        );
+        for (const auto& cacheControlOverride: spaceMapping.cacheControlOverrides) {
+            const auto matchName = (
+                cacheControlOverride.pattern.find('/') == std::string::npos
+            );
+            if (
+                GlobMatches(
+                    cacheControlOverride.pattern,
+                    matchName ? name : relativePath
+                )
+            ) {
+                return cacheControlOverride.cacheControl;
+            }
+        }
+        return spaceMapping.cacheControl;
+    }
+
+    /**
+     * This function adds to the given response the headers which tell the
+     * client when the given file was last modified and how long it may
+     * use its copy of the file.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the file.
+     *
+     * @param[in] relativePath
+     *     This is the path of the file, relative to the root of the space.
+     *
+     * @param[in] fileInfo
+     *     This is the metadata of the file.
+     *
+     * @param[in,out] response
+     *     This is the response to which to add the headers.
+     */
+    void AddFreshnessHeaders(
+        const SpaceMapping& spaceMapping,
+        const std::string& relativePath,
+        const FileInfo& fileInfo,
+        Http::Response& response
+    ) {
+        response.headers.AddHeader("Last-Modified", FormatHttpDate(fileInfo.lastModifiedTime));
+        const auto& cacheControl = GetCacheControl(spaceMapping, relativePath);
+        if (!cacheControl.empty()) {
+            response.headers.AddHeader("Cache-Control", cacheControl);
+        }
+    }
+
+    /**
+     * This function returns the extension of sidecar files holding
+     * variants of files encoded with the given content coding.
+     *
+     * @param[in] coding
+     *     This is the name of the content coding.
+     *
+     * @return
+     *     The extension of the sidecar files is returned.
+     *
+     * @retval nullptr
+     *     This is returned if there is no kind of sidecar file
+     *     for the given content coding.
+     */
+    const char* GetSidecarExtension(const std::string& coding) {
+        for (const auto& sidecar: SIDECARS) {
+            if (sidecar.coding == coding) {
+                return sidecar.extension;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * This function looks for precompressed "sidecar" files next to
+     * the file at the given path, if the given space serves them.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the file.
+     *
+     * @param[in] path
+     *     This is the path of the file.
+     *
+     * @param[out] sidecars
+     *     This is where to store the metadata of the sidecar files
+     *     found, keyed by content coding.
+     */
+    void FindSidecars(
+        const SpaceMapping& spaceMapping,
+        const std::string& path,
+        std::map< std::string, FileInfo >& sidecars
+    ) {
+        if (!spaceMapping.precompressed) {
+            return;
+        }
+        for (const auto& sidecar: SIDECARS) {
+            FileInfo sidecarInfo;
+            if (
+                GetFileInfo(path + sidecar.extension, sidecarInfo)
+                && !sidecarInfo.isDirectory
+            ) {
+                sidecars[sidecar.coding] = sidecarInfo;
+            }
+        }
+    }
+
+    /**
+     * This function looks up the cache entry for the given version of
+     * the file at the given path, building the entry and adding it
+     * to the cache if necessary.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the file.
+     *
+     * @param[in] path
+     *     This is the path of the file.
+     *
+     * @param[in] fileInfo
+     *     This is the current metadata of the file.
+     *
+     * @param[out] response
+     *     This is where to store the error response if the file
+     *     could not be read.
+     *
+     * @return
+     *     The cache entry for the file is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the file could not be read.
+     */
+    std::shared_ptr< const ContentCache::Entry > GetEntry(
+        const SpaceMapping& spaceMapping,
+        const std::string& path,
+        const FileInfo& fileInfo,
+        Http::Response& response
+    ) {
+        auto entry = spaceMapping.cache->Lookup(path, fileInfo);
+        if (entry != nullptr) {
+            return entry;
+        }
+        const auto newEntry = std::make_shared< ContentCache::Entry >();
+        newEntry->path = path;
+        newEntry->fileInfo = fileInfo;
+        DetermineContentType(
+            spaceMapping,
+            path,
+            newEntry->contentType,
+            newEntry->isWorthyOfBeingGzipped
+        );
+        if (IsMappable(spaceMapping, fileInfo.size)) {
+            newEntry->mapping = FileMapping::Map(
+                path,
+                (size_t)fileInfo.size,
+                spaceMapping.diagnosticMessageDelegate
+            );
+        }
+        if (spaceMapping.weakEntityTags) {
+            newEntry->entityTag = MakeWeakEntityTag(fileInfo);
+        } else if (newEntry->mapping != nullptr) {
+            newEntry->entityTag = MakeStrongEntityTag(
+                newEntry->mapping->GetData(),
+                newEntry->mapping->GetSize()
+            );
+        } else {
+            if (!ReadFile(path, fileInfo, newEntry->content, response)) {
+                return nullptr;
+            }
+            newEntry->content = Deduplicate(spaceMapping.contentStore, newEntry->content);
+            newEntry->entityTag = MakeStrongEntityTag(
+                newEntry->content->data(),
+                newEntry->content->length()
+            );
+        }
+        FindSidecars(spaceMapping, path, newEntry->sidecars);
+        CacheEntry(*spaceMapping.cache, newEntry);
+        return newEntry;
+    }
+
+    /**
+     * This function looks up the cache entry for the asset at the given
+     * path within the archive from which the given space is served,
+     * building the entry from the archive's index, and adding it to the
+     * cache, if necessary.  The entry refers to the contents of the
+     * asset, and any precompressed variants of it, in place within
+     * the archive, so nothing is copied.
+     *
+     * @param[in] spaceMapping
+     *     This is the space served from the archive.
+     *
+     * @param[in] relativePath
+     *     This is the path of the asset, relative to the root
+     *     of the archive.
+     *
+     * @param[in] path
+     *     This is the path under which to cache the asset.
+     *
+     * @return
+     *     The cache entry for the asset is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the asset isn't in the archive.
+     */
+    std::shared_ptr< const ContentCache::Entry > GetArchivedEntry(
+        const SpaceMapping& spaceMapping,
+        const std::string& relativePath,
+        const std::string& path
+    ) {
+        AssetArchive::Asset asset;
+        if (!spaceMapping.archive->Find(relativePath, asset)) {
+            return nullptr;
+        }
+        FileInfo fileInfo;
+        fileInfo.isExisting = true;
+        fileInfo.size = asset.identity.size;
+        fileInfo.lastModifiedTime = asset.lastModifiedTime;
+        auto entry = spaceMapping.cache->Lookup(path, fileInfo);
+        if (entry != nullptr) {
+            return entry;
+        }
+        const auto newEntry = std::make_shared< ContentCache::Entry >();
+        newEntry->path = path;
+        newEntry->fileInfo = fileInfo;
+        newEntry->contentType.assign(asset.contentType, asset.contentTypeLength);
+        newEntry->entityTag.assign(asset.entityTag, asset.entityTagLength);
+        newEntry->mapping = spaceMapping.archive->GetBlob(asset.identity);
+        if (newEntry->mapping == nullptr) {
+            newEntry->content = std::make_shared< std::string >();
+        }
+        const std::pair< const char*, AssetArchive::Blob > encodings[] = {
+            {"br", asset.brotli},
+            {"gzip", asset.gzip},
+        };
+        for (const auto& encoding: encodings) {
+            auto blob = spaceMapping.archive->GetBlob(encoding.second);
+            if (blob != nullptr) {
+                newEntry->encodings[encoding.first] = std::move(blob);
+            }
+        }
+        CacheEntry(*spaceMapping.cache, newEntry);
+        return newEntry;
+    }
+
+    /**
+     * This function gets the contents of the file described by the
+     * given cache entry, reading them if they aren't cached.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the file.
+     *
+     * @param[in] entry
+     *     This is the cache entry for the file.
+     *
+     * @param[out] content
+     *     This is where to store the contents of the file.
+     *
+     * @param[out] response
+     *     This is where to store the error response if the file
+     *     could not be read.
+     *
+     * @return
+     *     An indication of whether or not the contents of the file
+     *     were obtained successfully is returned.
+     */
+    bool GetContent(
+        const SpaceMapping& spaceMapping,
+        const std::shared_ptr< const ContentCache::Entry >& entry,
+        std::shared_ptr< const std::string >& content,
+        Http::Response& response
+    ) {
+        content = entry->content;
+        if (content != nullptr) {
+            return true;
+        }
+        if (!ReadFile(entry->path, entry->fileInfo, content, response)) {
+            return false;
+        }
+        if (spaceMapping.weakEntityTags) {
+            content = Deduplicate(spaceMapping.contentStore, content);
+            const auto loadedEntry = std::make_shared< ContentCache::Entry >(*entry);
+            loadedEntry->content = content;
+            CacheEntry(*spaceMapping.cache, loadedEntry);
+        }
+        return true;
+    }
+
+    /**
+     * This function gets an encoded variant of the contents of the file
+     * described by the given cache entry, either from the cache, from
+     * a precompressed sidecar file, or by compressing the file contents.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the file.
+     *
+     * @param[in] entry
+     *     This is the cache entry for the file.
+     *
+     * @param[in] coding
+     *     This is the name of the content coding of the variant to get.
+     *
+     * @param[out] content
+     *     This is where to store the variant.
+     *
+     * @param[out] response
+     *     This is where to store the error response if the file
+     *     could not be read.
+     *
+     * @return
+     *     An indication of whether or not the variant was obtained
+     *     successfully is returned.
+     */
+    bool GetVariant(
+        const SpaceMapping& spaceMapping,
+        const std::shared_ptr< const ContentCache::Entry >& entry,
+        const std::string& coding,
+        std::shared_ptr< const std::string >& content,
+        Http::Response& response
+    ) {
+        content = spaceMapping.cache->LookupVariant(entry->path, entry->fileInfo, coding);
+        if (content != nullptr) {
+            return true;
+        }
+        const auto sidecar = entry->sidecars.find(coding);
+        if (sidecar != entry->sidecars.end()) {
+            if (
+                !ReadFile(
+                    entry->path + GetSidecarExtension(coding),
+                    sidecar->second,
+                    content,
+                    response
+                )
+            ) {
+                spaceMapping.cache->Remove(entry->path);
+                return false;
+            }
+        } else {
+            std::shared_ptr< const std::string > identity;
+            const char* input;
+            size_t inputSize;
+            if (entry->mapping != nullptr) {
+                input = entry->mapping->GetData();
+                inputSize = entry->mapping->GetSize();
+            } else {
+                if (!GetContent(spaceMapping, entry, identity, response)) {
+                    return false;
+                }
+                input = identity->data();
+                inputSize = identity->length();
+            }
+            const auto variant = std::make_shared< std::string >();
+            if (
+                !Compress(
+                    coding,
+                    spaceMapping.compression,
+                    input,
+                    inputSize,
+                    *variant
+                )
+            ) {
+                response.statusCode = 500;
+                response.reasonPhrase = "Unable to compress file";
+                response.headers.AddHeader("Content-Type", "text/plain");
+                response.body = StringExtensions::sprintf(
+                    "Error compressing file '%s'",
+                    entry->path.c_str()
+                );
+                return false;
+            }
+            content = variant;
+        }
+        content = Deduplicate(spaceMapping.contentStore, content);
+        (void)spaceMapping.cache->InsertVariant(entry->path, entry->fileInfo, coding, content);
+        return true;
+    }
+
+    /**
+     * This function compresses the contents of the file described by
+     * the given cache entry, using the given content coding and
+     * settings.  It's used to compress files in the background.
+     *
+     * @param[in] entry
+     *     This is the cache entry for the file.
+     *
+     * @param[in] coding
+     *     This is the name of the content coding to use.
+     *
+     * @param[in] settings
+     *     These are the settings to use to compress the file.
+     *
+     * @return
+     *     The compressed contents of the file are returned.
+     *
+     * @retval nullptr
+     *     This is returned if the file couldn't be read or compressed.
+     */
+    std::shared_ptr< const std::string > CompressEntry(
+        const std::shared_ptr< const ContentCache::Entry >& entry,
+        const std::string& coding,
+        const CompressionSettings& settings
+    ) {
+        auto identity = entry->content;
+        const char* input;
+        size_t inputSize;
+        if (entry->mapping != nullptr) {
+            input = entry->mapping->GetData();
+            inputSize = entry->mapping->GetSize();
+        } else {
+            Http::Response response;
+            if (
+                (identity == nullptr)
+                && !ReadFile(entry->path, entry->fileInfo, identity, response)
+            ) {
+                return nullptr;
+            }
+            input = identity->data();
+            inputSize = identity->length();
+        }
+        const auto variant = std::make_shared< std::string >();
+        if (
+            !Compress(
+                coding,
+                settings,
+                input,
+                inputSize,
+                *variant
+            )
+        ) {
+            return nullptr;
+        }
+        return variant;
+    }
+
+    /**
+     * This function queues the compression of the file described by the
+     * given cache entry, using the given content coding, in the
+     * background.  The file is compressed quickly first, and the variant
+     * made is added to the cache.  Later, when there's time, the file
+     * is compressed again, as tightly as possible, and the variant in
+     * the cache is replaced.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the file.
+     *
+     * @param[in] entry
+     *     This is the cache entry for the file.
+     *
+     * @param[in] coding
+     *     This is the name of the content coding to use.
+     */
+    void CompressInBackground(
+        const SpaceMapping& spaceMapping,
+        const std::shared_ptr< const ContentCache::Entry >& entry,
+        const std::string& coding
+    ) {
+        // The jobs don't hold onto the queue which runs them, since it
+        // would then hold onto itself until they're run.
+        const auto cache = spaceMapping.cache;
+        const auto contentStore = spaceMapping.contentStore;
+        const std::weak_ptr< CompressionQueue > weakCompressionQueue(spaceMapping.compressionQueue);
+        const auto key = coding + ":" + entry->path;
+        auto fastSettings = spaceMapping.compression;
+        fastSettings.gzipLevel = FAST_GZIP_LEVEL;
+        fastSettings.brotliQuality = FAST_BROTLI_QUALITY;
+        auto bestSettings = spaceMapping.compression;
+        bestSettings.gzipLevel = BEST_GZIP_LEVEL;
+        bestSettings.brotliQuality = BEST_BROTLI_QUALITY;
+        (void)spaceMapping.compressionQueue->Submit(
+            key,
+            CompressionQueue::Priority::Urgent,
+            [cache, contentStore, weakCompressionQueue, key, entry, coding, fastSettings, bestSettings]{
+                auto fastVariant = CompressEntry(entry, coding, fastSettings);
+                if (fastVariant == nullptr) {
+                    return;
+                }
+                fastVariant = Deduplicate(contentStore, fastVariant);
+                const auto compressionQueue = weakCompressionQueue.lock();
+                if (
+                    !cache->InsertVariant(entry->path, entry->fileInfo, coding, fastVariant)
+                    || (compressionQueue == nullptr)
+                ) {
+                    return;
+                }
+                (void)compressionQueue->Submit(
+                    "best:" + key,
+                    CompressionQueue::Priority::Idle,
+                    [cache, contentStore, entry, coding, fastVariant, bestSettings]{
+                        if (cache->LookupVariant(entry->path, entry->fileInfo, coding) != fastVariant) {
+                            return;
+                        }
+                        const auto bestVariant = CompressEntry(entry, coding, bestSettings);
+                        if (
+                            (bestVariant != nullptr)
+                            && (bestVariant->length() < fastVariant->length())
+                        ) {
+                            (void)cache->ReplaceVariant(
+                                entry->path,
+                                entry->fileInfo,
+                                coding,
+                                fastVariant,
+                                Deduplicate(contentStore, bestVariant)
+                            );
+                        }
+                    }
+                );
+            }
+        );
+    }
+
+    /**
+     * This function determines whether or not the "If-Range" header
+     * of the given request, if any, permits a partial response for
+     * the file described by the given cache entry.
+     *
+     * @param[in] request
+     *     This is the request for the file.
+     *
+     * @param[in] entry
+     *     This is the cache entry for the file.
+     *
+     * @return
+     *     An indication of whether or not a partial response
+     *     is permitted is returned.
+     */
+    bool IfRangeMatches(
+        const Http::Request& request,
+        const std::shared_ptr< const ContentCache::Entry >& entry
+    ) {
+        if (!request.headers.HasHeader("If-Range")) {
+            return true;
+        }
+
+        // A date matches only if it's exactly the modification time
+        // of the file.
+        const auto ifRange = StringExtensions::Trim(request.headers.GetHeaderValue("If-Range"));
+        int64_t ifRangeDate;
+        if (ParseHttpDate(ifRange, ifRangeDate)) {
+            return (ifRangeDate == entry->fileInfo.lastModifiedTime);
+        }
+
+        // If-Range requires the "strong" comparison function,
+        // so weak entity tags never match.
+        return (
+            (ifRange.compare(0, 2, "W/") != 0)
+            && (ifRange == entry->entityTag)
+        );
+    }
+
+    /**
+     * This function appends the given range of bytes of the file
+     * described by the given cache entry to the given string.  Only
+     * the bytes in the range are read from the file system, if the
+     * file contents aren't cached.  Note that this saves reading the
+     * whole file only if its entity tag is weak; a strong entity tag
+     * is computed from the whole file when its cache entry is built,
+     * before any range of it is served.
+     *
+     * @param[in] entry
+     *     This is the cache entry for the file.
+     *
+     * @param[in,out] file
+     *     This is the file to read, if its contents aren't cached.
+     *     It's opened the first time it's needed.
+     *
+     * @param[in] range
+     *     This is the range of bytes to append.
+     *
+     * @param[in,out] body
+     *     This is the string to which to append the bytes.
+     *
+     * @param[out] response
+     *     This is where to store the error response if the file
+     *     could not be read.
+     *
+     * @return
+     *     An indication of whether or not the bytes were appended
+     *     successfully is returned.
+     */
+    bool AppendByteRange(
+        const std::shared_ptr< const ContentCache::Entry >& entry,
+        std::unique_ptr< SystemAbstractions::File >& file,
+        const ByteRange& range,
+        std::string& body,
+        Http::Response& response
+    ) {
+        const auto length = (size_t)range.GetLength();
+        if (entry->content != nullptr) {
+            (void)body.append(*entry->content, (size_t)range.first, length);
+            return true;
+        }
+        if (entry->mapping != nullptr) {
+            (void)body.append(entry->mapping->GetData() + range.first, length);
+            return true;
+        }
+        if (file == nullptr) {
+            file.reset(new SystemAbstractions::File(entry->path));
+            if (!file->OpenReadOnly()) {
+                response.statusCode = 500;
+                response.reasonPhrase = "Unable to open file";
+                response.headers.AddHeader("Content-Type", "text/plain");
+                response.body = StringExtensions::sprintf(
+                    "Error opening file '%s'",
+                    entry->path.c_str()
+                );
+                return false;
+            }
+        }
+        const auto offset = body.length();
+        body.resize(offset + length);
+        file->SetPosition(range.first);
+        if (file->Read(&body[offset], length) != length) {
+            response.statusCode = 500;
+            response.reasonPhrase = "Unable to read file";
+            response.headers.AddHeader("Content-Type", "text/plain");
+            response.body = StringExtensions::sprintf(
+                "Error reading file '%s'",
+                entry->path.c_str()
+            );
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * This function generates a boundary string for delimiting the
+     * parts of a "multipart/byteranges" response body.
+     *
+     * @return
+     *     The generated boundary string is returned.
+     */
+    std::string MakeMultipartBoundary() {
+        static thread_local std::mt19937_64 generator((std::random_device())());
+        return StringExtensions::sprintf(
+            "%016" PRIx64 "%016" PRIx64,
+            (uint64_t)generator(),
+            (uint64_t)generator()
+        );
+    }
+
+    /**
+     * This function sets the "Content-Range" header of the given response
+     * for the given range of a resource of the given size.
+     *
+     * @param[in,out] response
+     *     This is the response for which to set the header.
+     *
+     * @param[in] range
+     *     This is the range of the resource held in the response.
+     *
+     * @param[in] size
+     *     This is the size of the resource.
+     */
+    void SetContentRange(
+        Http::Response& response,
+        const ByteRange& range,
+        uint64_t size
+    ) {
+        response.headers.SetHeader(
+            "Content-Range",
+            StringExtensions::sprintf(
+                "bytes %" PRIu64 "-%" PRIu64 "/%" PRIu64,
+                range.first,
+                range.last,
+                size
+            )
+        );
+    }
+
+    /**
+     * This function builds a "206 Partial Content" response holding the
+     * given ranges of the file described by the given cache entry, or
+     * a "416 Range Not Satisfiable" response if there are no ranges.
+     *
+     * @param[in] entry
+     *     This is the cache entry for the file.
+     *
+     * @param[in] ranges
+     *     These are the ranges of the file to serve.
+     *
+     * @param[out] response
+     *     This is where to store the response.
+     *
+     * @return
+     *     An indication of whether or not the response was built
+     *     successfully is returned.  If not, the response holds
+     *     an error.
+     */
+    bool ServeByteRanges(
+        const std::shared_ptr< const ContentCache::Entry >& entry,
+        const std::vector< ByteRange >& ranges,
+        Http::Response& response
+    ) {
+        const auto size = entry->fileInfo.size;
+        if (ranges.empty()) {
+            response.statusCode = 416;
+            response.reasonPhrase = "Range Not Satisfiable";
+            response.headers.AddHeader(
+                "Content-Range",
+                StringExtensions::sprintf("bytes */%" PRIu64, size)
+            );
+            return true;
+        }
+        std::unique_ptr< SystemAbstractions::File > file;
+        if (ranges.size() == 1) {
+            const auto& range = ranges[0];
+            response.body.reserve((size_t)range.GetLength());
+            if (!AppendByteRange(entry, file, range, response.body, response)) {
+                return false;
+            }
+            response.headers.AddHeader("Content-Type", entry->contentType);
+            SetContentRange(response, range, size);
+        } else {
+            const auto boundary = MakeMultipartBoundary();
+            std::string body;
+            for (const auto& range: ranges) {
+                body += StringExtensions::sprintf(
+                    "\r\n--%s\r\n"
+                    "Content-Type: %s\r\n"
+                    "Content-Range: bytes %" PRIu64 "-%" PRIu64 "/%" PRIu64 "\r\n"
+                    "\r\n",
+                    boundary.c_str(),
+                    entry->contentType.c_str(),
+                    range.first,
+                    range.last,
+                    size
+                );
+                if (!AppendByteRange(entry, file, range, body, response)) {
+                    return false;
+                }
+            }
+            body += "\r\n--" + boundary + "--\r\n";
+            response.body = std::move(body);
+            response.headers.AddHeader(
+                "Content-Type",
+                "multipart/byteranges; boundary=" + boundary
+            );
+        }
+        response.statusCode = 206;
+        response.reasonPhrase = "Partial Content";
+        return true;
+    }
+
+    /**
+     * This function selects the content coding to apply when serving
+     * the file described by the given cache entry.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the file.
+     *
+     * @param[in] entry
+     *     This is the cache entry for the file.
+     *
+     * @param[in] request
+     *     This is the request for the file.
+     *
+     * @return
+     *     The name of the content coding to apply is returned.
+     *
+     * @retval ""
+     *     This is returned if the file should be served as is.
+     */
+    std::string SelectContentCoding(
+        const SpaceMapping& spaceMapping,
+        const std::shared_ptr< const ContentCache::Entry >& entry,
+        const Http::Request& request
+    ) {
+        const auto acceptEncoding = request.headers.GetHeaderValue("Accept-Encoding");
+        if (
+            !entry->sidecars.empty()
+            || !entry->encodings.empty()
+        ) {
+            std::vector< std::string > sidecarCodings;
+            for (const auto& sidecar: SIDECARS) {
+                if (
+                    (entry->sidecars.find(sidecar.coding) != entry->sidecars.end())
+                    || (entry->encodings.find(sidecar.coding) != entry->encodings.end())
+                ) {
+                    sidecarCodings.push_back(sidecar.coding);
+                }
+            }
+            const auto coding = NegotiateContentCoding(acceptEncoding, sidecarCodings);
+            if (!coding.empty()) {
+                return coding;
+            }
+        }
+        if (entry->isWorthyOfBeingGzipped) {
+            return NegotiateContentCoding(acceptEncoding, spaceMapping.compression.codings);
+        }
+        return "";
+    }
+
+    /**
+     * This function determines whether or not the directory at the given
+     * path within the given space has an index file, consulting the
+     * space's archive or path index, if any, instead of the file system.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the directory.
+     *
+     * @param[in] relativePath
+     *     This is the path of the directory, relative to the root
+     *     of the space.
+     *
+     * @return
+     *     An indication of whether or not the directory has
+     *     an index file is returned.
+     */
+    bool HasIndexFile(
+        const SpaceMapping& spaceMapping,
+        const std::string& relativePath
+    ) {
+        const auto indexPath = relativePath + "/" + spaceMapping.indexFile;
+        if (spaceMapping.archive != nullptr) {
+            AssetArchive::Asset asset;
+            return spaceMapping.archive->Find(indexPath, asset);
+        }
+        std::shared_ptr< const std::string > indexedPath;
+        if (
+            (spaceMapping.pathIndex != nullptr)
+            && spaceMapping.pathIndex->Find(indexPath, indexedPath)
+        ) {
+            return (indexedPath != nullptr);
+        }
+        FileInfo fileInfo;
+        return (
+            GetFileInfo(spaceMapping.root + "/" + indexPath, fileInfo)
+            && !fileInfo.isDirectory
+        );
+    }
 
     /**
-     * This represents one space of server resources and how they
-     * should be mapped to the file system.
+     * This function builds a response redirecting the client to the
+     * canonical path of the given directory, which ends in a slash,
+     * so that relative references in the directory's index file
+     * are resolved correctly.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the directory.
+     *
+     * @param[in] request
+     *     This is the request for the directory.
+     *
+     * @param[in] relativePath
+     *     This is the path of the directory, relative to the root
+     *     of the space.
+     *
+     * @return
+     *     The response to return to the client is returned.
      */
-    struct SpaceMapping {
-        /**
-         * This is the path to the resource space in the server.
-         */
-        std::vector< std::string > space;
+    Http::Response RedirectToDirectory(
+        const SpaceMapping& spaceMapping,
+        const Http::Request& request,
+        const std::string& relativePath
+    ) {
+        // The segments of the path have already been decoded, so the
+        // location is put back together with the URI library, which
+        // encodes any characters in them which need it.
+        std::vector< std::string > path{""};
+        for (const auto& segment: spaceMapping.space) {
+            if (!segment.empty()) {
+                path.push_back(segment);
+            }
+        }
+        for (const auto& segment: StringExtensions::Split(relativePath, '/')) {
+            path.push_back(segment);
+        }
+        path.push_back("");
+        Uri::Uri location;
+        location.SetPath(path);
+        const auto query = request.target.GetQuery();
+        if (!query.empty()) {
+            location.SetQuery(query);
+        }
+        Http::Response response;
+        response.statusCode = 301;
+        response.reasonPhrase = "Moved Permanently";
+        response.headers.AddHeader("Location", location.GenerateString());
+        SetContentLength(response);
+        return response;
+    }
 
-        /**
-         * This is the file system path to the files to be served.
-         */
-        std::string root;
+    /**
+     * This function builds a response reporting the statistics
+     * of the cache of the given space, along with those of the store
+     * used to deduplicate contents, if the space uses it.
+     *
+     * @param[in] spaceMapping
+     *     This is the space whose statistics are to be reported.
+     *
+     * @return
+     *     The response to return to the client is returned.
+     */
+    Http::Response ServeStatistics(const SpaceMapping& spaceMapping) {
+        const auto statistics = spaceMapping.cache->GetStatistics();
+        Http::Response response;
+        response.statusCode = 200;
+        response.reasonPhrase = "OK";
+        response.headers.AddHeader("Content-Type", "application/json");
+        response.headers.AddHeader("Cache-Control", "no-store");
+        auto body = Json::Object({
+            {"hits", (size_t)statistics.hits},
+            {"misses", (size_t)statistics.misses},
+            {"evictions", (size_t)statistics.evictions},
+            {"rejections", (size_t)statistics.rejections},
+            {"entries", statistics.entries},
+            {"residentBytes", statistics.residentBytes},
+            {"capacity", statistics.capacity},
+        });
+        if (spaceMapping.contentStore != nullptr) {
+            const auto storeStatistics = spaceMapping.contentStore->GetStatistics();
+            body.Set(
+                "deduplication",
+                Json::Object({
+                    {"contents", storeStatistics.contents},
+                    {"bytes", storeStatistics.bytes},
+                    {"duplicates", (size_t)storeStatistics.duplicates},
+                    {"duplicateBytes", (size_t)storeStatistics.duplicateBytes},
+                })
+            );
+        }
+        response.body = body.ToEncoding();
+        SetContentLength(response);
+        return response;
+    }
 
-        /**
-         * This is the function to call in order to unregister
-         * the plug-in as handling this server resource space.
-         */
-        Http::IServer::UnregistrationDelegate unregistrationDelegate;
-    };
+    /**
+     * This function determines whether or not every directory in the
+     * given space is being watched for changes, so that files cached
+     * for the space can be served without checking the file system.
+     *
+     * @param[in] spaceMapping
+     *     This is the space to check.
+     *
+     * @return
+     *     An indication of whether or not the space is being watched
+     *     is returned.
+     */
+    bool IsWatched(const SpaceMapping& spaceMapping) {
+        return (
+            (spaceMapping.monitor != nullptr)
+            && *spaceMapping.isWatched
+        );
+    }
 
     /**
-     * This function configures the given space mapping from
-     * the given configuration items.
+     * This function determines whether or not the given segment of the
+     * path of a request can be joined safely onto the root of a space.
+     * Since path segments have their percent-encodings decoded, a single
+     * segment may hold separators as well as dot segments, so those are
+     * refused wherever they are.
      *
-     * @param[in,out] spaceMapping
-     *     This is the space mapping to configure.
+     * @param[in] segment
+     *     This is the path segment to check.
      *
-     * @parma[in] configuration
-     *     This contains the items used to configure the space mapping.
+     * @return
+     *     An indication of whether or not the path segment
+     *     is safe is returned.
+     */
+    bool IsSafePathSegment(const std::string& segment) {
+        return (
+            (segment != ".")
+            && (segment != "..")
+            && (segment.find_first_of(std::string("/\\\0", 3)) == std::string::npos)
+        );
+    }
+
+    /**
+     * This function handles a request for a resource within
+     * the given space.
      *
-     * @param[in] diagnosticMessageDelegate
-     *     This is the function to call to deliver diagnostic
-     *     messages generated by the plug-in.
+     * @param[in] spaceMapping
+     *     This is the space in which the resource was requested.
+     *
+     * @param[in] request
+     *     This is the request to handle.
      *
      * @return
-     *     An indication of whether or not the space mapping
-     *     was successfully configured is returned.
+     *     The response to return to the client is returned.
      */
-    bool ConfigureSpaceMapping(
-        SpaceMapping& spaceMapping,
-        Json::Value configuration,
-        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
+    Http::Response ServeResource(
+        const SpaceMapping& spaceMapping,
+        const Http::Request& request
     ) {
-        // Determine the resource space we're serving.
-        Uri::Uri uri;
-        if (!configuration.Has("space")) {
-            diagnosticMessageDelegate(
-                "",
-                SystemAbstractions::DiagnosticsSender::Levels::ERROR,
-                "no 'space' URI in configuration"
-            );
-            return false;
+        // Attempts to reach outside the root of the space
+        // are turned away before anything else is done.
+        const auto& segments = request.target.GetPath();
+        if (
+            std::find_if_not(
+                segments.begin(),
+                segments.end(),
+                IsSafePathSegment
+            ) != segments.end()
+        ) {
+            return *spaceMapping.notFoundResponse;
         }
-        if (!uri.ParseFromString(configuration["space"])) {
-            diagnosticMessageDelegate(
-                "",
-                SystemAbstractions::DiagnosticsSender::Levels::ERROR,
-                "unable to parse 'space' URI in configuration"
+        auto relativePath = StringExtensions::Join(segments, "/");
+        const auto isHead = (request.method == "HEAD");
+        const auto isWatched = IsWatched(spaceMapping);
+        const auto notFoundCache = (
+            isWatched
+            ? spaceMapping.notFoundCache
+            : nullptr
+        );
+        if (
+            !spaceMapping.statisticsPath.empty()
+            && (relativePath == spaceMapping.statisticsPath)
+        ) {
+            return ServeStatistics(spaceMapping);
+        }
+
+        // A request for a directory (a path ending in a slash, or the
+        // root of the space) is answered with the directory's index
+        // file, which is then served like any other file.  Any other
+        // request may turn out to be for a directory with an index file,
+        // in which case the client is redirected to the same path with
+        // a slash.
+        const auto isDirectoryRequest = (
+            relativePath.empty()
+            || (relativePath.back() == '/')
+        );
+        if (
+            isDirectoryRequest
+            && !spaceMapping.indexFile.empty()
+        ) {
+            relativePath += spaceMapping.indexFile;
+        }
+        const auto mayBeDirectory = (
+            !isDirectoryRequest
+            && !spaceMapping.indexFile.empty()
+        );
+
+        // If the space is indexed, the path of the file is found in the
+        // index, and if it isn't there, the file doesn't exist.
+        std::shared_ptr< const std::string > indexedPath;
+        if (
+            (spaceMapping.pathIndex != nullptr)
+            && spaceMapping.pathIndex->Find(relativePath, indexedPath)
+            && (indexedPath == nullptr)
+        ) {
+            if (
+                mayBeDirectory
+                && HasIndexFile(spaceMapping, relativePath)
+            ) {
+                return RedirectToDirectory(spaceMapping, request, relativePath);
+            }
+            return *spaceMapping.notFoundResponse;
+        }
+        std::string joinedPath;
+        if (indexedPath == nullptr) {
+            joinedPath = StringExtensions::Join(
+                {
+                    spaceMapping.root,
+                    relativePath
+                },
+                "/"
             );
-            return false;
         }
-        spaceMapping.space = uri.GetPath();
-        (void)spaceMapping.space.erase(spaceMapping.space.begin());
+        const auto& path = (
+            (indexedPath == nullptr)
+            ? joinedPath
+            : *indexedPath
+        );
+        Http::Response response;
 
-        // Determine where to locate the static content.
-        if (!configuration.Has("root")) {
-            diagnosticMessageDelegate(
-                "",
-                SystemAbstractions::DiagnosticsSender::Levels::ERROR,
-                "no 'root' URI in configuration"
+        // If the space is being watched for changes, a cached entry
+        // known to be current can be used without checking the file.
+        // Otherwise, look up the file's metadata, noting the generation
+        // of the cache first, so that the entry isn't marked as current
+        // if the file changes before the entry is cached.
+        // If the space is served from an archive, the file system isn't
+        // consulted at all.
+        // Likewise, paths recently found not to exist are turned away
+        // without checking the file system again, and a path found not
+        // to exist is remembered only if nothing changed meanwhile.
+        std::shared_ptr< const ContentCache::Entry > entry;
+        uint64_t generation = 0;
+        uint64_t notFoundGeneration = 0;
+        if (spaceMapping.archive != nullptr) {
+            entry = GetArchivedEntry(spaceMapping, relativePath, path);
+        } else if (isWatched) {
+            entry = spaceMapping.cache->LookupCurrent(path);
+            generation = spaceMapping.cache->GetGeneration();
+            if (notFoundCache != nullptr) {
+                notFoundGeneration = notFoundCache->GetGeneration();
+            }
+        }
+        FileInfo fileInfo;
+        if (entry != nullptr) {
+            fileInfo = entry->fileInfo;
+        } else if (
+            (spaceMapping.archive != nullptr)
+            || (
+                (notFoundCache != nullptr)
+                && notFoundCache->IsMissing(relativePath)
+            )
+        ) {
+            if (
+                (spaceMapping.archive != nullptr)
+                && mayBeDirectory
+                && HasIndexFile(spaceMapping, relativePath)
+            ) {
+                return RedirectToDirectory(spaceMapping, request, relativePath);
+            }
+            return *spaceMapping.notFoundResponse;
+        } else if (!GetFileInfo(path, fileInfo)) {
+            if (notFoundCache != nullptr) {
+                notFoundCache->MarkMissing(relativePath, notFoundGeneration);
+            }
+            return *spaceMapping.notFoundResponse;
+        }
+
+        // Directories found to have index files are remembered in the
+        // cache, like files, so that requests for them can be redirected
+        // without checking for their index files every time.  Other
+        // directories are treated as missing.
+        if (fileInfo.isDirectory) {
+            if (entry == nullptr) {
+                entry = spaceMapping.cache->Lookup(path, fileInfo);
+                if (entry == nullptr) {
+                    if (
+                        !mayBeDirectory
+                        || !HasIndexFile(spaceMapping, relativePath)
+                    ) {
+                        if (notFoundCache != nullptr) {
+                            notFoundCache->MarkMissing(relativePath, notFoundGeneration);
+                        }
+                        return *spaceMapping.notFoundResponse;
+                    }
+                    const auto newEntry = std::make_shared< ContentCache::Entry >();
+                    newEntry->path = path;
+                    newEntry->fileInfo = fileInfo;
+                    CacheEntry(*spaceMapping.cache, newEntry);
+                }
+                if (isWatched) {
+                    spaceMapping.cache->MarkCurrent(path, fileInfo, generation);
+                }
+            }
+            return RedirectToDirectory(spaceMapping, request, relativePath);
+        }
+        // A HEAD request gets the same cache entry as a GET request, so
+        // that it's given the same entity tag, even though, with strong
+        // entity tags, this means reading and hashing a file which isn't
+        // cached yet.
+        if (entry == nullptr) {
+            entry = GetEntry(spaceMapping, path, fileInfo, response);
+            if (entry == nullptr) {
+                SetContentLength(response);
+                return response;
+            }
+            if (isWatched) {
+                spaceMapping.cache->MarkCurrent(path, fileInfo, generation);
+            }
+        }
+        std::vector< ByteRange > ranges;
+        const auto rangesRequested = (
+            !isHead
+            && request.headers.HasHeader("Range")
+            && IfRangeMatches(request, entry)
+            && ParseByteRanges(
+                request.headers.GetHeaderValue("Range"),
+                entry->fileInfo.size,
+                MAX_BYTE_RANGES,
+                ranges
+            )
+        );
+        auto coding = (
+            rangesRequested
+            ? ""
+            : SelectContentCoding(spaceMapping, entry, request)
+        );
+
+        // If files are compressed in the background, a file which hasn't
+        // been compressed yet is served as is meanwhile.
+        if (
+            !coding.empty()
+            && !isHead
+            && (spaceMapping.compressionQueue != nullptr)
+            && (entry->sidecars.find(coding) == entry->sidecars.end())
+            && (entry->encodings.find(coding) == entry->encodings.end())
+            && (spaceMapping.cache->LookupVariant(entry->path, entry->fileInfo, coding) == nullptr)
+        ) {
+            CompressInBackground(spaceMapping, entry, coding);
+            coding.clear();
+        }
+
+        // For a HEAD request, an encoded variant is described only if its
+        // length is known without making it.  Otherwise, the file is
+        // described as is.
+        auto headLength = entry->fileInfo.size;
+        if (
+            isHead
+            && !coding.empty()
+        ) {
+            const auto sidecar = entry->sidecars.find(coding);
+            const auto encoding = entry->encodings.find(coding);
+            if (sidecar != entry->sidecars.end()) {
+                headLength = sidecar->second.size;
+            } else if (encoding != entry->encodings.end()) {
+                headLength = encoding->second->GetSize();
+            } else {
+                const auto variant = spaceMapping.cache->LookupVariant(entry->path, entry->fileInfo, coding);
+                if (variant == nullptr) {
+                    coding.clear();
+                } else {
+                    headLength = variant->length();
+                }
+            }
+        }
+        // A variant compressed in the background is first made quickly
+        // and later replaced by a smaller one, so the bytes served under
+        // its entity tag change, and the tag can only be weak.
+        auto etag = (
+            coding.empty()
+            ? entry->entityTag
+            : MakeVariantEntityTag(entry->entityTag, coding)
+        );
+        if (
+            !coding.empty()
+            && (spaceMapping.compressionQueue != nullptr)
+            && (entry->sidecars.find(coding) == entry->sidecars.end())
+            && (entry->encodings.find(coding) == entry->encodings.end())
+            && (etag.compare(0, 2, "W/") != 0)
+        ) {
+            etag = "W/" + etag;
+        }
+
+        // A response serving the whole file has the same header block
+        // every time, so it's made once and kept along with the file's
+        // cache entry, to be reused for as long as the file doesn't change.
+        const auto isNotModified = IsNotModified(request, etag, entry->fileInfo);
+        std::shared_ptr< const Http::Response > responseTemplate;
+        if (
+            !isNotModified
+            && !rangesRequested
+        ) {
+            responseTemplate = spaceMapping.cache->LookupResponse(entry->path, entry->fileInfo, coding);
+        }
+        if (isNotModified) {
+            response.statusCode = 304;
+            response.reasonPhrase = "Not Modified";
+        } else if (rangesRequested) {
+            if (!ServeByteRanges(entry, ranges, response)) {
+                SetContentLength(response);
+                return response;
+            }
+            response.headers.AddHeader("Accept-Ranges", "bytes");
+            if (
+                entry->isWorthyOfBeingGzipped
+                || !entry->sidecars.empty()
+                || !entry->encodings.empty()
+            ) {
+                response.headers.AddHeader("Vary", "Accept-Encoding");
+            }
+            response.headers.AddHeader("ETag", etag);
+            AddFreshnessHeaders(spaceMapping, relativePath, entry->fileInfo, response);
+        } else {
+            const auto encoding = entry->encodings.find(coding);
+            if (isHead) {
+                // Nothing is sent, so there's nothing to read.
+            } else if (
+                coding.empty()
+                && (entry->mapping != nullptr)
+            ) {
+                response.body.assign(
+                    entry->mapping->GetData(),
+                    entry->mapping->GetSize()
+                );
+            } else if (encoding != entry->encodings.end()) {
+                response.body.assign(
+                    encoding->second->GetData(),
+                    encoding->second->GetSize()
+                );
+            } else {
+                std::shared_ptr< const std::string > content;
+                if (
+                    coding.empty()
+                    ? !GetContent(spaceMapping, entry, content, response)
+                    : !GetVariant(spaceMapping, entry, coding, content, response)
+                ) {
+                    SetContentLength(response);
+                    return response;
+                }
+                response.body = *content;
+            }
+            response.statusCode = 200;
+            response.reasonPhrase = "OK";
+        }
+        if (responseTemplate != nullptr) {
+            response.headers = responseTemplate->headers;
+            return response;
+        }
+        if (response.statusCode == 200) {
+            response.headers.AddHeader("Accept-Ranges", "bytes");
+        }
+        // Responses to range requests (including "416 Range Not
+        // Satisfiable") have their headers added above.
+        if (!rangesRequested) {
+            response.headers.AddHeader("Content-Type", entry->contentType);
+            if (
+                entry->isWorthyOfBeingGzipped
+                || !entry->sidecars.empty()
+                || !entry->encodings.empty()
+            ) {
+                response.headers.AddHeader("Vary", "Accept-Encoding");
+            }
+            if (!coding.empty()) {
+                response.headers.AddHeader("Content-Encoding", coding);
+            }
+            response.headers.AddHeader("ETag", etag);
+            AddFreshnessHeaders(spaceMapping, relativePath, entry->fileInfo, response);
+        }
+        if (
+            isHead
+            && (response.statusCode == 200)
+        ) {
+            response.headers.SetHeader(
+                "Content-Length",
+                StringExtensions::sprintf("%" PRIu64, headLength)
             );
-            return false;
+        } else {
+            SetContentLength(response);
         }
-        spaceMapping.root = (std::string)configuration["root"];
-        if (!SystemAbstractions::File::IsAbsolutePath(spaceMapping.root)) {
-            spaceMapping.root = SystemAbstractions::File::GetExeParentDirectory() + "/" + spaceMapping.root;
+        if (response.statusCode == 200) {
+            const auto newResponseTemplate = std::make_shared< Http::Response >();
+            newResponseTemplate->statusCode = response.statusCode;
+            newResponseTemplate->reasonPhrase = response.reasonPhrase;
+            newResponseTemplate->headers = response.headers;
+            (void)spaceMapping.cache->InsertResponse(
+                entry->path,
+                entry->fileInfo,
+                coding,
+                newResponseTemplate
+            );
         }
-        return true;
+        return response;
+    }
+
+    /**
+     * This function warms up the cache of the given space for the file
+     * at the given path, building its cache entry, and reading and
+     * compressing its contents, if it's small enough.
+     *
+     * @param[in] spaceMapping
+     *     This is the space containing the file.
+     *
+     * @param[in] path
+     *     This is the file system path of the file.
+     *
+     * @param[in] fileInfo
+     *     This is the metadata of the file.
+     *
+     * @return
+     *     The outcome of preloading the file is returned.
+     */
+    Preloader::Result PreloadFile(
+        const SpaceMapping& spaceMapping,
+        const std::string& path,
+        FileInfo fileInfo
+    ) {
+        if (spaceMapping.cache->GetResidentBytes() >= spaceMapping.cache->GetCapacity()) {
+            return Preloader::Result::Stop;
+        }
+
+        // Sidecar files are loaded along with the files they accompany.
+        if (spaceMapping.precompressed) {
+            for (const auto& sidecar: SIDECARS) {
+                const auto extensionLength = strlen(sidecar.extension);
+                FileInfo originalInfo;
+                if (
+                    (path.length() > extensionLength)
+                    && (path.compare(path.length() - extensionLength, extensionLength, sidecar.extension) == 0)
+                    && GetFileInfo(path.substr(0, path.length() - extensionLength), originalInfo)
+                ) {
+                    return Preloader::Result::Skipped;
+                }
+            }
+        }
+        const auto isSmall = (fileInfo.size <= spaceMapping.preloadMaxFileSize);
+        if (
+            !isSmall
+            && !spaceMapping.weakEntityTags
+        ) {
+            return Preloader::Result::Skipped;
+        }
+
+        // As when serving a request, the generation of the cache must be
+        // noted before looking up the file's metadata, for the entry to
+        // be marked as current.
+        uint64_t generation = 0;
+        if (IsWatched(spaceMapping)) {
+            generation = spaceMapping.cache->GetGeneration();
+            if (!GetFileInfo(path, fileInfo)) {
+                return Preloader::Result::Skipped;
+            }
+        }
+        Http::Response response;
+        const auto entry = GetEntry(spaceMapping, path, fileInfo, response);
+        if (entry == nullptr) {
+            return Preloader::Result::Skipped;
+        }
+        if (IsWatched(spaceMapping)) {
+            spaceMapping.cache->MarkCurrent(path, fileInfo, generation);
+        }
+        if (isSmall) {
+            std::shared_ptr< const std::string > content;
+            if (entry->mapping == nullptr) {
+                (void)GetContent(spaceMapping, entry, content, response);
+            }
+            if (entry->isWorthyOfBeingGzipped) {
+                for (const auto& coding: spaceMapping.compression.codings) {
+                    (void)GetVariant(spaceMapping, entry, coding, content, response);
+                }
+            }
+        }
+        return Preloader::Result::Loaded;
     }
 
 }
@@ -173,117 +2608,84 @@ extern "C" API void LoadPlugin(
         spaceMappings.push_back(std::move(spaceMapping));
     }
 
+    // Share one store among all spaces which deduplicate contents,
+    // so that identical contents are held in memory only once.
+    const auto contentStore = std::make_shared< ContentStore >();
+    for (auto& spaceMapping: spaceMappings) {
+        if (spaceMapping.deduplicate) {
+            spaceMapping.contentStore = contentStore;
+        }
+    }
+
     // Register to handle requests for the space we're serving.
     for (auto& spaceMapping: spaceMappings) {
-        auto root = spaceMapping.root;
+        if (spaceMapping.compressionQueue != nullptr) {
+            spaceMapping.compressionQueue->Start();
+        }
+        if (spaceMapping.monitor != nullptr) {
+            const auto cache = spaceMapping.cache;
+            const auto notFoundCache = spaceMapping.notFoundCache;
+            const auto pathIndex = spaceMapping.pathIndex;
+            const auto isWatched = spaceMapping.isWatched = std::make_shared< std::atomic< bool > >(false);
+            if (
+                !spaceMapping.monitor->Start(
+                    spaceMapping.root,
+                    [cache, notFoundCache, pathIndex, isWatched](
+                        const std::vector< std::string >& files,
+                        bool isComplete,
+                        bool isTreeWatched
+                    ){
+                        // Files in directories which aren't watched could
+                        // change without notice, so the index and the
+                        // filter of missing paths can't be trusted.
+                        *isWatched = isTreeWatched;
+                        if (notFoundCache != nullptr) {
+                            notFoundCache->Reset(files, isComplete && isTreeWatched);
+                        }
+                        if (pathIndex != nullptr) {
+                            pathIndex->Reset(files, isComplete && isTreeWatched);
+                        }
+                        cache->Clear();
+                    }
+                )
+            ) {
+                diagnosticMessageDelegate(
+                    "",
+                    SystemAbstractions::DiagnosticsSender::Levels::WARNING,
+                    StringExtensions::sprintf(
+                        "unable to watch '%s' for changes; files will be checked on every request",
+                        spaceMapping.root.c_str()
+                    )
+                );
+                spaceMapping.monitor = nullptr;
+                spaceMapping.notFoundCache = nullptr;
+                spaceMapping.pathIndex = nullptr;
+            }
+        }
+        if (spaceMapping.preloader != nullptr) {
+            // The preloader isn't given its own space mapping, since it
+            // would then hold onto itself.
+            auto preloadSpaceMapping = spaceMapping;
+            preloadSpaceMapping.preloader = nullptr;
+            spaceMapping.preloader->Start(
+                spaceMapping.root,
+                [preloadSpaceMapping](
+                    const std::string& path,
+                    const FileInfo& fileInfo
+                ){
+                    return PreloadFile(preloadSpaceMapping, path, fileInfo);
+                }
+            );
+        }
+        const auto spaceMappingCopy = spaceMapping;
         spaceMapping.unregistrationDelegate = server->RegisterResource(
             spaceMapping.space,
-            [root](
+            [spaceMappingCopy](
                 const Http::Request& request,
                 std::shared_ptr< Http::Connection > connection,
                 const std::string& trailer
             ){
-                const auto path = StringExtensions::Join(
-                    {
-                        root,
-                        StringExtensions::Join(request.target.GetPath(), "/")
-                    },
-                    "/"
-                );
-                SystemAbstractions::File file(path);
-                Http::Response response;
-                if (
-                    file.IsExisting()
-                    && !file.IsDirectory()
-                ) {
-                    if (file.OpenReadOnly()) {
-                        SystemAbstractions::File::Buffer buffer(file.GetSize());
-                        if (file.Read(buffer) == buffer.size()) {
-                            auto etag = Hash::BytesToString< Hash::Sha1 >(buffer);
-                            if (
-                                request.headers.HasHeader("If-None-Match")
-                                && (request.headers.GetHeaderValue("If-None-Match") == etag)
-                            ) {
-                                response.statusCode = 304;
-                                response.reasonPhrase = "Not Modified";
-                            } else {
-                                response.statusCode = 200;
-                                response.reasonPhrase = "OK";
-                                response.body.assign(
-                                    buffer.begin(),
-                                    buffer.end()
-                                );
-                            }
-                            bool isWorthyOfBeingGzipped = false;
-                            if (
-                                (path.length() >= 5)
-                                && (path.substr(path.length() - 5) == ".html")
-                            ) {
-                                response.headers.AddHeader("Content-Type", "text/html");
-                                isWorthyOfBeingGzipped = true;
-                            } else if (
-                                (path.length() >= 3)
-                                && (path.substr(path.length() - 3) == ".js")
-                            ) {
-                                response.headers.AddHeader("Content-Type", "application/javascript");
-                                isWorthyOfBeingGzipped = true;
-                            } else if (
-                                (path.length() >= 4)
-                                && (path.substr(path.length() - 4) == ".css")
-                            ) {
-                                response.headers.AddHeader("Content-Type", "text/css");
-                                isWorthyOfBeingGzipped = true;
-                            } else if (
-                                (path.length() >= 4)
-                                && (path.substr(path.length() - 4) == ".txt")
-                            ) {
-                                response.headers.AddHeader("Content-Type", "text/plain");
-                                isWorthyOfBeingGzipped = true;
-                            } else if (
-                                (path.length() >= 4)
-                                && (path.substr(path.length() - 4) == ".ico")
-                            ) {
-                                response.headers.AddHeader("Content-Type", "image/x-icon");
-                            } else {
-                                response.headers.AddHeader("Content-Type", "text/plain");
-                            }
-                            if (
-                                (request.headers.HasHeaderToken("Accept-Encoding", "gzip"))
-                                && isWorthyOfBeingGzipped
-                            )  {
-                                response.headers.SetHeader("Content-Encoding", "gzip");
-                                etag += "-gzip";
-                            }
-                            response.headers.AddHeader("ETag", etag);
-                        } else {
-                            response.statusCode = 500;
-                            response.reasonPhrase = "Unable to read file";
-                            response.headers.AddHeader("Content-Type", "text/plain");
-                            response.body = StringExtensions::sprintf(
-                                "Error reading file '%s'",
-                                path.c_str()
-                            );
-                        }
-                    } else {
-                        response.statusCode = 500;
-                        response.reasonPhrase = "Unable to open file";
-                        response.headers.AddHeader("Content-Type", "text/plain");
-                        response.body = StringExtensions::sprintf(
-                            "Error opening file '%s'",
-                            path.c_str()
-                        );
-                    }
-                } else {
-                    response.statusCode = 404;
-                    response.reasonPhrase = "Not Found";
-                    response.headers.AddHeader("Content-Type", "text/plain");
-                    response.body = StringExtensions::sprintf(
-                        "File '%s' not found.",
-                        path.c_str()
-                    );
-                }
-                response.headers.AddHeader("Content-Length", StringExtensions::sprintf("%zu", response.body.length()));
-                return response;
+                return ServeResource(spaceMappingCopy, request);
             }
         );
     }
@@ -292,6 +2694,15 @@ extern "C" API void LoadPlugin(
     unloadDelegate = [spaceMappings]{
         for (const auto& spaceMapping: spaceMappings) {
             spaceMapping.unregistrationDelegate();
+            if (spaceMapping.compressionQueue != nullptr) {
+                spaceMapping.compressionQueue->Stop();
+            }
+            if (spaceMapping.preloader != nullptr) {
+                spaceMapping.preloader->Stop();
+            }
+            if (spaceMapping.monitor != nullptr) {
+                spaceMapping.monitor->Stop();
+            }
         }
     };
 }
@@ -0,0 +1,311 @@
+/**
+ * @file TreeMonitor.cpp
+ *
+ * This module contains the implementation of the TreeMonitor class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "FileInfo.hpp"
+#include "TreeMonitor.hpp"
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <StringExtensions/StringExtensions.hpp>
+#include <SystemAbstractions/DirectoryMonitor.hpp>
+#include <SystemAbstractions/File.hpp>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * This holds the state of one directory being watched.
+     */
+    struct MonitoredDirectory {
+        /**
+         * This is the inode (or file index) of the directory when it
+         * started being watched, used to notice when a directory is
+         * replaced by another of the same name.
+         */
+        uint64_t inode = 0;
+
+        /**
+         * This watches the directory for changes.
+         */
+        std::unique_ptr< SystemAbstractions::DirectoryMonitor > monitor;
+    };
+
+}
+
+/**
+ * This contains the private properties of the TreeMonitor class.
+ */
+struct TreeMonitor::Impl {
+    // Properties
+
+    /**
+     * This is the function to call to publish any diagnostic messages.
+     */
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate;
+
+    /**
+     * This is the path of the directory at the root of the tree.
+     */
+    std::string root;
+
+    /**
+     * This is the function to call with the files in the tree
+     * whenever anything in the tree changes.
+     */
+    ChangeDelegate changeDelegate;
+
+    /**
+     * These are the directories being watched, keyed by path.
+     */
+    std::map< std::string, MonitoredDirectory > directories;
+
+    /**
+     * This is used to synchronize access to the directories being watched.
+     * It's separate from the mutex used to signal the worker thread,
+     * since directory monitors are stopped while holding it, and their
+     * threads may be waiting to signal the worker thread at the time.
+     */
+    mutable std::mutex directoriesMutex;
+
+    /**
+     * This thread rescans the tree and calls the change delegate
+     * whenever anything in the tree changes.
+     */
+    std::thread worker;
+
+    /**
+     * This is used to signal the worker thread to wake up.
+     */
+    std::condition_variable wakeCondition;
+
+    /**
+     * This is used to synchronize access to the state shared
+     * with the worker thread.
+     */
+    std::mutex mutex;
+
+    /**
+     * This flag indicates whether or not anything in the tree
+     * has changed since the worker thread last woke up.
+     */
+    bool changed = false;
+
+    /**
+     * This flag indicates whether or not the worker thread
+     * should exit.
+     */
+    bool stop = false;
+
+    // Methods
+
+    /**
+     * This method is called by the directory monitors whenever
+     * anything in a directory they're watching changes.
+     */
+    void OnChange() {
+        std::lock_guard< decltype(mutex) > lock(mutex);
+        changed = true;
+        wakeCondition.notify_all();
+    }
+
+    /**
+     * This method finds all directories in the tree, starts watching
+     * any which aren't being watched yet, and stops watching any which
+     * no longer exist.
+     *
+     * @param[out] files
+     *     This is where to store the paths of all the files found
+     *     in the tree, relative to the root of the tree.
+     *
+     * @param[out] isComplete
+     *     This is where to store an indication of whether or not
+     *     each directory in the tree was found through only one path.
+     *
+     * @param[out] isWatched
+     *     This is where to store an indication of whether or not
+     *     every directory found in the tree is being watched.
+     *
+     * @return
+     *     An indication of whether or not the root directory
+     *     is being watched is returned.
+     */
+    bool Rescan(
+        std::vector< std::string >& files,
+        bool& isComplete,
+        bool& isWatched
+    ) {
+        // Find all the directories in the tree, keeping track of which
+        // ones have been seen, so that symbolic links which form
+        // cycles don't lead to an endless scan.
+        std::map< std::string, uint64_t > found;
+        std::set< uint64_t > seen;
+        std::vector< std::string > unvisited{root};
+        files.clear();
+        isComplete = true;
+        while (!unvisited.empty()) {
+            const auto directory = std::move(unvisited.back());
+            unvisited.pop_back();
+            FileInfo fileInfo;
+            if (
+                !GetFileInfo(directory, fileInfo)
+                || !fileInfo.isDirectory
+            ) {
+                continue;
+            }
+            if (!seen.insert(fileInfo.inode).second) {
+                isComplete = false;
+                continue;
+            }
+            found[directory] = fileInfo.inode;
+            std::vector< std::string > children;
+            SystemAbstractions::File::ListDirectory(directory, children);
+            for (const auto& child: children) {
+                FileInfo childInfo;
+                if (!GetFileInfo(child, childInfo)) {
+                    continue;
+                }
+                if (childInfo.isDirectory) {
+                    unvisited.push_back(child);
+                } else {
+                    files.push_back(child.substr(root.length() + 1));
+                }
+            }
+        }
+
+        // Stop watching directories which are gone or replaced,
+        // and start watching new ones.
+        std::lock_guard< decltype(directoriesMutex) > lock(directoriesMutex);
+        for (auto directory = directories.begin(); directory != directories.end(); ) {
+            const auto foundDirectory = found.find(directory->first);
+            if (
+                (foundDirectory == found.end())
+                || (foundDirectory->second != directory->second.inode)
+            ) {
+                directory->second.monitor->Stop();
+                directory = directories.erase(directory);
+            } else {
+                ++directory;
+            }
+        }
+        isWatched = true;
+        for (const auto& foundDirectory: found) {
+            if (directories.find(foundDirectory.first) != directories.end()) {
+                continue;
+            }
+            MonitoredDirectory directory;
+            directory.inode = foundDirectory.second;
+            directory.monitor.reset(new SystemAbstractions::DirectoryMonitor());
+            if (
+                !directory.monitor->Start(
+                    [this]{ OnChange(); },
+                    foundDirectory.first
+                )
+            ) {
+                diagnosticMessageDelegate(
+                    "TreeMonitor",
+                    SystemAbstractions::DiagnosticsSender::Levels::WARNING,
+                    StringExtensions::sprintf(
+                        "unable to monitor directory '%s'",
+                        foundDirectory.first.c_str()
+                    )
+                );
+                isWatched = false;
+                continue;
+            }
+            directories[foundDirectory.first] = std::move(directory);
+        }
+        return (directories.find(root) != directories.end());
+    }
+
+    /**
+     * This function is called in its own worker thread.  It waits for
+     * anything in the tree to change, then rescans the tree and calls
+     * the change delegate.
+     */
+    void Run() {
+        std::vector< std::string > files;
+        bool isComplete;
+        bool isWatched;
+        std::unique_lock< std::mutex > lock(mutex);
+        while (!stop) {
+            wakeCondition.wait(
+                lock,
+                [this]{ return stop || changed; }
+            );
+            if (stop) {
+                break;
+            }
+            changed = false;
+            lock.unlock();
+
+            // Rescan before calling the delegate, so that anything which
+            // changes in a new directory after the delegate is called
+            // is noticed.
+            const auto isRootWatched = Rescan(files, isComplete, isWatched);
+            changeDelegate(files, isComplete, isRootWatched && isWatched);
+            lock.lock();
+        }
+    }
+};
+
+TreeMonitor::~TreeMonitor() noexcept {
+    Stop();
+}
+
+TreeMonitor::TreeMonitor(
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
+)
+    : impl_(new Impl())
+{
+    impl_->diagnosticMessageDelegate = diagnosticMessageDelegate;
+}
+
+bool TreeMonitor::Start(
+    const std::string& root,
+    ChangeDelegate changeDelegate
+) {
+    Stop();
+    impl_->root = root;
+    impl_->changeDelegate = changeDelegate;
+    impl_->changed = false;
+    impl_->stop = false;
+    std::vector< std::string > files;
+    bool isComplete;
+    bool isWatched;
+    if (!impl_->Rescan(files, isComplete, isWatched)) {
+        Stop();
+        return false;
+    }
+    changeDelegate(files, isComplete, isWatched);
+    impl_->worker = std::thread(&Impl::Run, impl_.get());
+    return true;
+}
+
+void TreeMonitor::Stop() {
+    if (impl_->worker.joinable()) {
+        {
+            std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+            impl_->stop = true;
+            impl_->wakeCondition.notify_all();
+        }
+        impl_->worker.join();
+    }
+    std::lock_guard< decltype(impl_->directoriesMutex) > lock(impl_->directoriesMutex);
+    for (auto& directory: impl_->directories) {
+        directory.second.monitor->Stop();
+    }
+    impl_->directories.clear();
+}
+
+size_t TreeMonitor::GetMonitoredDirectories() const {
+    std::lock_guard< decltype(impl_->directoriesMutex) > lock(impl_->directoriesMutex);
+    return impl_->directories.size();
+}
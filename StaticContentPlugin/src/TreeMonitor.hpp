@@ -0,0 +1,133 @@
+#ifndef STATIC_CONTENT_PLUGIN_TREE_MONITOR_HPP
+#define STATIC_CONTENT_PLUGIN_TREE_MONITOR_HPP
+
+/**
+ * @file TreeMonitor.hpp
+ *
+ * This module declares the TreeMonitor class.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <functional>
+#include <memory>
+#include <stddef.h>
+#include <string>
+#include <SystemAbstractions/DiagnosticsSender.hpp>
+#include <vector>
+
+/**
+ * This class watches a directory and all of its subdirectories for
+ * changes, and calls a delegate whenever anything in them changes.
+ *
+ * Each directory is watched with its own
+ * SystemAbstractions::DirectoryMonitor, which doesn't say what changed,
+ * so the delegate isn't told either.  Whenever anything changes, the
+ * tree is rescanned, in order to watch any new subdirectories (and stop
+ * watching removed ones), before the delegate is called with the files
+ * found by the scan.  Changes arriving while the delegate is busy are
+ * coalesced into a single further call.
+ *
+ * Directories which can't be watched (for example, because the system
+ * ran out of watches) are tried again on every rescan, and the delegate
+ * is told whether or not the whole tree is being watched, since changes
+ * in a directory which isn't watched go unnoticed.
+ */
+class TreeMonitor {
+    // Types
+public:
+    /**
+     * This is the type of function called with the files in the tree.
+     *
+     * @param[in] files
+     *     These are the paths of all the files in the tree, relative
+     *     to the root of the tree, using "/" as the delimiter.
+     *
+     * @param[in] isComplete
+     *     This indicates whether or not the files are all the paths
+     *     through which files in the tree may be reached.  This is not
+     *     the case if any directory in the tree is reachable by more than
+     *     one path (through symbolic links), since each directory is
+     *     scanned only once.
+     *
+     * @param[in] isWatched
+     *     This indicates whether or not every directory in the tree
+     *     is being watched for changes.
+     */
+    typedef std::function<
+        void(
+            const std::vector< std::string >& files,
+            bool isComplete,
+            bool isWatched
+        )
+    > ChangeDelegate;
+
+    // Lifecycle Methods
+public:
+    ~TreeMonitor() noexcept;
+    TreeMonitor(const TreeMonitor&) = delete;
+    TreeMonitor(TreeMonitor&&) noexcept = delete;
+    TreeMonitor& operator=(const TreeMonitor&) = delete;
+    TreeMonitor& operator=(TreeMonitor&&) noexcept = delete;
+
+    // Public Methods
+public:
+    /**
+     * This is the constructor of the class.
+     *
+     * @param[in] diagnosticMessageDelegate
+     *     This is the function to call to publish any diagnostic messages.
+     */
+    explicit TreeMonitor(
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate
+    );
+
+    /**
+     * This method starts watching the given directory tree.
+     *
+     * @param[in] root
+     *     This is the path of the directory at the root of the tree.
+     *
+     * @param[in] changeDelegate
+     *     This is the function to call with the files in the tree,
+     *     once before this method returns, and again, from a worker
+     *     thread, whenever anything in the tree changes.
+     *
+     * @return
+     *     An indication of whether or not the root directory
+     *     could be watched is returned.
+     */
+    bool Start(
+        const std::string& root,
+        ChangeDelegate changeDelegate
+    );
+
+    /**
+     * This method stops watching the directory tree.
+     */
+    void Stop();
+
+    /**
+     * This method returns the number of directories being watched.
+     *
+     * @return
+     *     The number of directories being watched is returned.
+     */
+    size_t GetMonitoredDirectories() const;
+
+    // Private properties
+private:
+    /**
+     * This is the type of structure that contains the private
+     * properties of the instance.  It is defined in the implementation
+     * and declared here to ensure that it is scoped inside the class.
+     */
+    struct Impl;
+
+    /**
+     * This contains the private properties of the instance.
+     */
+    std::unique_ptr< Impl > impl_;
+};
+
+#endif /* STATIC_CONTENT_PLUGIN_TREE_MONITOR_HPP */
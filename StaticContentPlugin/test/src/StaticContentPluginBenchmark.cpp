@@ -0,0 +1,160 @@
+/**
+ * @file StaticContentPluginBenchmark.cpp
+ *
+ * This module contains a benchmark of the request handler of the
+ * Static Content web-server plugin.  It drives the handler directly,
+ * through a mock server, with several mixes of requests, and reports
+ * throughput, latency, memory allocation and system calls for each.
+ *
+ * Usage: StaticContentPluginBenchmark [REQUESTS]
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include <functional>
+#include <map>
+#include <PluginBenchmark/PluginBenchmark.hpp>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <SystemAbstractions/File.hpp>
+#include <WebServer/PluginEntryPoint.hpp>
+
+#ifdef _WIN32
+#define API __declspec(dllimport)
+#else /* POSIX */
+#define API
+#endif /* _WIN32 / POSIX */
+extern "C" API void LoadPlugin(
+    Http::IServer* server,
+    Json::Value configuration,
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate diagnosticMessageDelegate,
+    std::function< void() >& unloadDelegate
+);
+
+namespace {
+
+    /**
+     * This is the number of requests made in each scenario,
+     * unless given on the command line.
+     */
+    constexpr size_t DEFAULT_REQUESTS = 20000;
+
+    /**
+     * This is the size, in bytes, of the "large" file served.
+     */
+    constexpr size_t LARGE_FILE_SIZE = 1024 * 1024;
+
+    /**
+     * This function builds a request for the given resource.
+     *
+     * @param[in] path
+     *     This is the path of the resource to request.
+     *
+     * @param[in] headers
+     *     These are the headers to add to the request.
+     *
+     * @return
+     *     The request is returned.
+     */
+    Http::Request MakeRequest(
+        const std::string& path,
+        const std::map< std::string, std::string >& headers = {}
+    ) {
+        Http::Request request;
+        request.method = "GET";
+        request.target.SetPath({path});
+        for (const auto& header: headers) {
+            request.headers.SetHeader(header.first, header.second);
+        }
+        return request;
+    }
+
+}
+
+/**
+ * This function is the entrypoint of the program.
+ *
+ * @param[in] argc
+ *     This is the number of command-line arguments given to the program.
+ *
+ * @param[in] argv
+ *     This is the array of command-line arguments given to the program.
+ */
+int main(int argc, char* argv[]) {
+    size_t numRequests = DEFAULT_REQUESTS;
+    if (!PluginBenchmark::ParseRequestCount(argc, argv, numRequests)) {
+        return EXIT_FAILURE;
+    }
+
+    // Create the files to serve.
+    const auto benchmarkAreaPath = SystemAbstractions::File::GetExeParentDirectory() + "/BenchmarkArea";
+    if (!SystemAbstractions::File::CreateDirectory(benchmarkAreaPath)) {
+        fprintf(stderr, "unable to create '%s'\n", benchmarkAreaPath.c_str());
+        return EXIT_FAILURE;
+    }
+    std::string smallFileContent;
+    while (smallFileContent.length() < 2048) {
+        smallFileContent += "<p>Hello, World!</p>\n";
+    }
+    std::string largeFileContent(LARGE_FILE_SIZE, '\0');
+    std::mt19937 generator;
+    for (auto& c: largeFileContent) {
+        c = (char)('a' + generator() % 26);
+    }
+    const std::pair< const char*, const std::string& > files[] = {
+        {"small.html", smallFileContent},
+        {"large.txt", largeFileContent},
+    };
+    for (const auto& file: files) {
+        SystemAbstractions::File testFile(benchmarkAreaPath + "/" + file.first);
+        (void)testFile.OpenReadWrite();
+        (void)testFile.Write(file.second.data(), file.second.length());
+        testFile.Close();
+    }
+
+    // Load the plug-in, serving the files.
+    PluginBenchmark::MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", benchmarkAreaPath);
+    config.Set("cacheSize", (int)(4 * LARGE_FILE_SIZE));
+    LoadPlugin(
+        &server,
+        config,
+        PluginBenchmark::PrintWarnings,
+        unloadDelegate
+    );
+    if (server.registeredResourceDelegate == nullptr) {
+        fprintf(stderr, "plug-in failed to load\n");
+        (void)SystemAbstractions::File::DeleteDirectory(benchmarkAreaPath);
+        return EXIT_FAILURE;
+    }
+
+    // Set up the scenarios, using the entity tag given for the small
+    // file to make requests revalidating it.
+    const auto& resourceDelegate = server.registeredResourceDelegate;
+    const auto smallFileEntityTag = resourceDelegate(
+        MakeRequest("small.html"),
+        nullptr,
+        ""
+    ).headers.GetHeaderValue("ETag");
+
+    // Run the scenarios and report the results.
+    PluginBenchmark::RunScenarios(
+        {
+            {"small", {MakeRequest("small.html")}},
+            {"large", {MakeRequest("large.txt")}},
+            {"revalidate", {MakeRequest("small.html", {{"If-None-Match", smallFileEntityTag}})}},
+            {"gzip", {MakeRequest("small.html", {{"Accept-Encoding", "gzip, deflate"}})}},
+            {"not-found", {MakeRequest("missing.html")}},
+        },
+        resourceDelegate,
+        numRequests
+    );
+    unloadDelegate();
+    (void)SystemAbstractions::File::DeleteDirectory(benchmarkAreaPath);
+    return EXIT_SUCCESS;
+}
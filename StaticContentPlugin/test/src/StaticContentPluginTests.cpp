@@ -7,13 +7,27 @@
  * © 2018-2019 by Richard Walters
  */
 
+#include <chrono>
 #include <gtest/gtest.h>
 #include <map>
+#include <mutex>
+#include <set>
 #include <Hash/Templates.hpp>
 #include <Hash/Sha1.hpp>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <StringExtensions/StringExtensions.hpp>
+#include <SystemAbstractions/DirectoryMonitor.hpp>
 #include <SystemAbstractions/File.hpp>
+#include <thread>
 #include <WebServer/PluginEntryPoint.hpp>
+#include <zlib.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <unistd.h>
+#endif /* POSIX */
 
 #ifdef _WIN32
 #define API __declspec(dllimport)
@@ -29,6 +43,68 @@ extern "C" API void LoadPlugin(
 
 namespace {
 
+    /**
+     * This function decompresses the given data, which was
+     * compressed using the "gzip" content coding.
+     *
+     * @param[in] input
+     *     This is the data to decompress.
+     *
+     * @return
+     *     The decompressed data is returned.
+     */
+    std::string Gunzip(const std::string& input) {
+        z_stream stream = {};
+        if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+            return "";
+        }
+        std::string output;
+        char buffer[4096];
+        stream.next_in = (Bytef*)input.data();
+        stream.avail_in = (uInt)input.length();
+        int result;
+        do {
+            stream.next_out = (Bytef*)buffer;
+            stream.avail_out = sizeof(buffer);
+            result = inflate(&stream, Z_NO_FLUSH);
+            output.append(buffer, sizeof(buffer) - stream.avail_out);
+        } while (result == Z_OK);
+        (void)inflateEnd(&stream);
+        return output;
+    }
+
+    /**
+     * This function compresses the given data, using the "gzip"
+     * content coding, at the given compression level.
+     *
+     * @param[in] input
+     *     This is the data to compress.
+     *
+     * @param[in] level
+     *     This is the compression level to use, from 1 to 9.
+     *
+     * @return
+     *     The compressed data is returned.
+     */
+    std::string Gzip(
+        const std::string& input,
+        int level
+    ) {
+        z_stream stream = {};
+        if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return "";
+        }
+        std::string output(deflateBound(&stream, (uLong)input.length()), '\0');
+        stream.next_in = (Bytef*)input.data();
+        stream.avail_in = (uInt)input.length();
+        stream.next_out = (Bytef*)&output[0];
+        stream.avail_out = (uInt)output.length();
+        (void)deflate(&stream, Z_FINISH);
+        output.resize(output.length() - stream.avail_out);
+        (void)deflateEnd(&stream);
+        return output;
+    }
+
     /**
      * This is a fake time-keeper which is used to test the server.
      */
@@ -331,6 +407,26 @@ TEST_F(StaticContentPluginTests, EntityTagComputedFromSha1) {
     // Verify entity tag was computed using SHA-1.
     const auto expectedEtag = Hash::StringToString< Hash::Sha1 >(testFileContent);
     EXPECT_EQ(expectedEtag, actualEtag);
+
+    // Verify the same for files whose sizes fall on either side
+    // of the boundaries between the blocks digested by SHA-1.
+    for (const size_t size: {0, 55, 56, 63, 64, 65, 119, 120, 1000}) {
+        const auto name = StringExtensions::sprintf("foo%zu.txt", size);
+        SystemAbstractions::File sizedTestFile(testAreaPath + "/" + name);
+        (void)sizedTestFile.OpenReadWrite();
+        std::string sizedTestFileContent;
+        for (size_t i = 0; i < size; ++i) {
+            sizedTestFileContent += (char)('a' + i % 26);
+        }
+        (void)sizedTestFile.Write(sizedTestFileContent.data(), sizedTestFileContent.length());
+        sizedTestFile.Close();
+        request.target.SetPath({name});
+        response = server.registeredResourceDelegate(request, nullptr, "");
+        EXPECT_EQ(
+            Hash::StringToString< Hash::Sha1 >(sizedTestFileContent),
+            response.headers.GetHeaderValue("ETag")
+        ) << size;
+    }
 }
 
 TEST_F(StaticContentPluginTests, ServeMultipleResourceSpaces) {
@@ -433,3 +529,1926 @@ TEST_F(StaticContentPluginTests, GzipServedTestFileIfClientAcceptsIt) {
         )
     );
 }
+
+TEST_F(StaticContentPluginTests, CachedFileRevalidatedWhenChanged) {
+    // Create test file.
+    SystemAbstractions::File testFile(testAreaPath + "/foo.txt");
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write("Hello!", 6);
+    testFile.Close();
+
+    // Configure plug-in.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set("cacheSize", 1024);
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+
+    // Request the test file twice, expecting the same
+    // content both times.
+    Http::Request request;
+    request.target.SetPath({"foo.txt"});
+    auto response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ("Hello!", response.body);
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ("Hello!", response.body);
+
+    // Change the test file, and expect the new content
+    // to be served.
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write("Hello, World!", 13);
+    testFile.Close();
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ("Hello, World!", response.body);
+    EXPECT_EQ(
+        Hash::StringToString< Hash::Sha1 >("Hello, World!"),
+        response.headers.GetHeaderValue("ETag")
+    );
+}
+
+TEST_F(StaticContentPluginTests, FilesLargerThanCacheStillServed) {
+    // Create test file.
+    SystemAbstractions::File testFile(testAreaPath + "/foo.txt");
+    (void)testFile.OpenReadWrite();
+    const std::string testFileContent(4096, 'x');
+    (void)testFile.Write(testFileContent.data(), testFileContent.length());
+    testFile.Close();
+
+    // Configure plug-in with a cache too small to hold the test file.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set("cacheSize", 0);
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+
+    // Request the test file twice, expecting the full
+    // content both times.
+    Http::Request request;
+    request.target.SetPath({"foo.txt"});
+    for (size_t i = 0; i < 2; ++i) {
+        const auto response = server.registeredResourceDelegate(request, nullptr, "");
+        EXPECT_EQ(200, response.statusCode);
+        EXPECT_EQ(testFileContent, response.body);
+    }
+}
+
+TEST_F(StaticContentPluginTests, WeakEntityTagsComputedFromMetadata) {
+    // Create test file.
+    SystemAbstractions::File testFile(testAreaPath + "/foo.txt");
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write("Hello!", 6);
+    testFile.Close();
+
+    // Configure plug-in to use weak entity tags, and not
+    // to cache anything, so that conditional requests
+    // are answered from file metadata alone.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set("cacheSize", 0);
+    config.Set("entityTags", "weak");
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+
+    // Send initial request to get the entity tag
+    // of the test file.
+    Http::Request request;
+    request.target.SetPath({"foo.txt"});
+    auto response = server.registeredResourceDelegate(request, nullptr, "");
+    ASSERT_EQ(200, response.statusCode);
+    EXPECT_EQ("Hello!", response.body);
+    const auto etag = response.headers.GetHeaderValue("ETag");
+    EXPECT_EQ("W/\"", etag.substr(0, 3));
+    EXPECT_NE(Hash::StringToString< Hash::Sha1 >("Hello!"), etag);
+
+    // Send conditional request, expecting "304 Not Modified".
+    request.headers.SetHeader("If-None-Match", etag);
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(304, response.statusCode);
+    EXPECT_TRUE(response.body.empty());
+    EXPECT_EQ(etag, response.headers.GetHeaderValue("ETag"));
+}
+
+TEST_F(StaticContentPluginTests, UnknownEntityTagModeFailsLoad) {
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set("entityTags", "sideways");
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+    EXPECT_TRUE(unloadDelegate == nullptr);
+}
+
+TEST_F(StaticContentPluginTests, GzipServedTestFileIsCompressed) {
+    // Create test file.
+    SystemAbstractions::File testFile(testAreaPath + "/foo.html");
+    (void)testFile.OpenReadWrite();
+    std::string testFileContent;
+    for (size_t i = 0; i < 100; ++i) {
+        testFileContent += "<p>Hello, World!</p>";
+    }
+    (void)testFile.Write(testFileContent.data(), testFileContent.length());
+    testFile.Close();
+
+    // Configure plug-in.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set(
+        "compression",
+        Json::Object({
+            {"codings", Json::Array({"gzip"})},
+            {"gzipLevel", 9},
+        })
+    );
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+
+    // Request the test file twice (the second time it should come
+    // from the cache), expecting it to be compressed both times.
+    Http::Request request;
+    request.headers.SetHeader("Accept-Encoding", "deflate, gzip;q=0.8");
+    request.target.SetPath({"foo.html"});
+    for (size_t i = 0; i < 2; ++i) {
+        const auto response = server.registeredResourceDelegate(request, nullptr, "");
+        EXPECT_EQ(200, response.statusCode);
+        EXPECT_EQ("gzip", response.headers.GetHeaderValue("Content-Encoding"));
+        EXPECT_EQ("Accept-Encoding", response.headers.GetHeaderValue("Vary"));
+        EXPECT_LT(response.body.length(), testFileContent.length());
+        EXPECT_EQ(testFileContent, Gunzip(response.body));
+        EXPECT_EQ(
+            StringExtensions::sprintf("%zu", response.body.length()),
+            response.headers.GetHeaderValue("Content-Length")
+        );
+    }
+}
+
+TEST_F(StaticContentPluginTests, GzipNotServedIfClientRefusesIt) {
+    // Create test file.
+    SystemAbstractions::File testFile(testAreaPath + "/foo.txt");
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write("Hello!", 6);
+    testFile.Close();
+
+    // Configure plug-in.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+
+    // Request the test file, refusing all content codings.
+    Http::Request request;
+    request.headers.SetHeader("Accept-Encoding", "gzip;q=0, *;q=0");
+    request.target.SetPath({"foo.txt"});
+    const auto response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_FALSE(response.headers.HasHeader("Content-Encoding"));
+    EXPECT_EQ("Hello!", response.body);
+    EXPECT_EQ(
+        Hash::StringToString< Hash::Sha1 >("Hello!"),
+        response.headers.GetHeaderValue("ETag")
+    );
+}
+
+TEST_F(StaticContentPluginTests, PrecompressedSidecarFilesServed) {
+    // Create test file and its precompressed sidecar files.
+    // The sidecar contents need not actually be compressed,
+    // since the plug-in should serve them as they are.
+    const std::vector< std::pair< std::string, std::string > > testFiles{
+        {"foo.js", "var x = 1;"},
+        {"foo.js.gz", "gzip sidecar"},
+        {"foo.js.br", "brotli sidecar"},
+    };
+    for (const auto& testFileEntry: testFiles) {
+        SystemAbstractions::File testFile(testAreaPath + "/" + testFileEntry.first);
+        (void)testFile.OpenReadWrite();
+        (void)testFile.Write(testFileEntry.second.data(), testFileEntry.second.length());
+        testFile.Close();
+    }
+
+    // Configure plug-in.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+
+    // Expect each sidecar to be served when the client
+    // prefers its content coding.
+    const std::string etag = Hash::StringToString< Hash::Sha1 >("var x = 1;");
+    Http::Request request;
+    request.target.SetPath({"foo.js"});
+    request.headers.SetHeader("Accept-Encoding", "gzip, br;q=0.5");
+    auto response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ("gzip sidecar", response.body);
+    EXPECT_EQ("gzip", response.headers.GetHeaderValue("Content-Encoding"));
+    EXPECT_EQ("Accept-Encoding", response.headers.GetHeaderValue("Vary"));
+    EXPECT_EQ("application/javascript", response.headers.GetHeaderValue("Content-Type"));
+    EXPECT_EQ(etag + "-gzip", response.headers.GetHeaderValue("ETag"));
+    request.headers.SetHeader("Accept-Encoding", "gzip, br");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ("brotli sidecar", response.body);
+    EXPECT_EQ("br", response.headers.GetHeaderValue("Content-Encoding"));
+    EXPECT_EQ(etag + "-br", response.headers.GetHeaderValue("ETag"));
+
+    // Expect the original file to be served when the client
+    // accepts no content codings.
+    request.headers.SetHeader("Accept-Encoding", "identity");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ("var x = 1;", response.body);
+    EXPECT_FALSE(response.headers.HasHeader("Content-Encoding"));
+    EXPECT_EQ(etag, response.headers.GetHeaderValue("ETag"));
+}
+
+TEST_F(StaticContentPluginTests, ByteRangeRequests) {
+    // Create test file.
+    SystemAbstractions::File testFile(testAreaPath + "/foo.txt");
+    (void)testFile.OpenReadWrite();
+    const std::string testFileContent = "Hello, World!";
+    (void)testFile.Write(testFileContent.data(), testFileContent.length());
+    testFile.Close();
+
+    // Configure plug-in, without caching, so that ranges
+    // are read from the file.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set("cacheSize", 0);
+    config.Set("entityTags", "weak");
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+
+    // Single range
+    Http::Request request;
+    request.target.SetPath({"foo.txt"});
+    request.headers.SetHeader("Accept-Encoding", "gzip");
+    request.headers.SetHeader("Range", "bytes=7-11");
+    auto response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(206, response.statusCode);
+    EXPECT_EQ("World", response.body);
+    EXPECT_EQ("bytes 7-11/13", response.headers.GetHeaderValue("Content-Range"));
+    EXPECT_EQ("5", response.headers.GetHeaderValue("Content-Length"));
+    EXPECT_FALSE(response.headers.HasHeader("Content-Encoding"));
+    EXPECT_EQ("Accept-Encoding", response.headers.GetHeaderValue("Vary"));
+
+    // Suffix range
+    request.headers.SetHeader("Range", "bytes=-6");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(206, response.statusCode);
+    EXPECT_EQ("World!", response.body);
+    EXPECT_EQ("bytes 7-12/13", response.headers.GetHeaderValue("Content-Range"));
+
+    // Multiple ranges
+    request.headers.SetHeader("Range", "bytes=0-4, 7-");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(206, response.statusCode);
+    const auto contentType = response.headers.GetHeaderValue("Content-Type");
+    const std::string multipartPrefix = "multipart/byteranges; boundary=";
+    ASSERT_EQ(multipartPrefix, contentType.substr(0, multipartPrefix.length()));
+    const auto boundary = contentType.substr(multipartPrefix.length());
+    EXPECT_EQ(
+        (
+            "\r\n--" + boundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 0-4/13\r\n"
+            "\r\n"
+            "Hello"
+            "\r\n--" + boundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 7-12/13\r\n"
+            "\r\n"
+            "World!"
+            "\r\n--" + boundary + "--\r\n"
+        ),
+        response.body
+    );
+
+    // Overlapping and adjacent ranges are coalesced.
+    request.headers.SetHeader("Range", "bytes=7-9, 0-2, 1-4, 10-");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(206, response.statusCode);
+    const auto coalescedBoundary = response.headers.GetHeaderValue("Content-Type").substr(multipartPrefix.length());
+    EXPECT_EQ(
+        (
+            "\r\n--" + coalescedBoundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 0-4/13\r\n"
+            "\r\n"
+            "Hello"
+            "\r\n--" + coalescedBoundary + "\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 7-12/13\r\n"
+            "\r\n"
+            "World!"
+            "\r\n--" + coalescedBoundary + "--\r\n"
+        ),
+        response.body
+    );
+    request.headers.SetHeader("Range", "bytes=0-4, 3-8");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(206, response.statusCode);
+    EXPECT_EQ("Hello, Wo", response.body);
+    EXPECT_EQ("bytes 0-8/13", response.headers.GetHeaderValue("Content-Range"));
+
+    // Ranges adding up to more than the whole file
+    // get the whole file instead.
+    request.headers.SetHeader("Range", "bytes=0-,0-,0-");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_FALSE(response.headers.HasHeader("Content-Range"));
+
+    // Unsatisfiable range
+    request.headers.SetHeader("Range", "bytes=20-30");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(416, response.statusCode);
+    EXPECT_EQ("bytes */13", response.headers.GetHeaderValue("Content-Range"));
+    size_t entityTags = 0;
+    size_t lastModifieds = 0;
+    for (const auto& header: response.headers.GetAll()) {
+        if (header.name == "ETag") {
+            ++entityTags;
+        } else if (header.name == "Last-Modified") {
+            ++lastModifieds;
+        }
+    }
+    EXPECT_EQ(1, entityTags);
+    EXPECT_EQ(1, lastModifieds);
+
+    // If-Range with weak entity tag never matches, so the whole
+    // file should be served.
+    request.headers.SetHeader("Range", "bytes=0-4");
+    request.headers.SetHeader("Accept-Encoding", "identity");
+    request.headers.SetHeader("If-Range", response.headers.GetHeaderValue("ETag"));
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ(testFileContent, response.body);
+    EXPECT_EQ("bytes", response.headers.GetHeaderValue("Accept-Ranges"));
+}
+
+TEST_F(StaticContentPluginTests, ByteRangeRequestWithMatchingIfRange) {
+    // Create test file.
+    SystemAbstractions::File testFile(testAreaPath + "/foo.txt");
+    (void)testFile.OpenReadWrite();
+    const std::string testFileContent = "Hello, World!";
+    (void)testFile.Write(testFileContent.data(), testFileContent.length());
+    testFile.Close();
+
+    // Configure plug-in.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+
+    // Expect range to be honored if the entity tag matches,
+    // and ignored if not.
+    Http::Request request;
+    request.target.SetPath({"foo.txt"});
+    request.headers.SetHeader("Range", "bytes=0-4");
+    request.headers.SetHeader("If-Range", Hash::StringToString< Hash::Sha1 >(testFileContent));
+    auto response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(206, response.statusCode);
+    EXPECT_EQ("Hello", response.body);
+    request.headers.SetHeader("If-Range", Hash::StringToString< Hash::Sha1 >("something else"));
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ(testFileContent, response.body);
+}
+
+TEST_F(StaticContentPluginTests, MidSizeFilesServedFromMappings) {
+    // Create test file.
+    SystemAbstractions::File testFile(testAreaPath + "/foo.txt");
+    (void)testFile.OpenReadWrite();
+    std::string testFileContent;
+    for (size_t i = 0; i < 50; ++i) {
+        testFileContent += StringExtensions::sprintf("Line %zu\r\n", i);
+    }
+    (void)testFile.Write(testFileContent.data(), testFileContent.length());
+    testFile.Close();
+
+    // Configure plug-in to map files from 100 to 10000 bytes in size.
+    // The diagnostic messages must outlive the server, since mappings
+    // still cached when the server goes away report being unmapped.
+    std::vector< std::string > diagnosticMessages;
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set(
+        "mmap",
+        Json::Object({
+            {"minSize", 100},
+            {"maxSize", 10000},
+        })
+    );
+    LoadPlugin(
+        &server,
+        config,
+        [&diagnosticMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            diagnosticMessages.push_back(
+                StringExtensions::sprintf(
+                    "%s[%zu]: %s",
+                    senderName.c_str(),
+                    level,
+                    message.c_str()
+                )
+            );
+        },
+        unloadDelegate
+    );
+
+    // Request the whole test file, expecting it to be mapped once
+    // and served from the mapping.
+    Http::Request request;
+    request.target.SetPath({"foo.txt"});
+    auto response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ(testFileContent, response.body);
+    EXPECT_EQ(
+        Hash::StringToString< Hash::Sha1 >(testFileContent),
+        response.headers.GetHeaderValue("ETag")
+    );
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(testFileContent, response.body);
+    ASSERT_EQ(1, diagnosticMessages.size());
+    EXPECT_EQ("FileMapping[0]: mapped '", diagnosticMessages[0].substr(0, 24));
+
+    // Request a range and a compressed variant of the test file,
+    // expecting both to be made from the mapping.
+    request.headers.SetHeader("Range", "bytes=10-19");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(206, response.statusCode);
+    EXPECT_EQ(testFileContent.substr(10, 10), response.body);
+    request.headers.RemoveHeader("Range");
+    request.headers.SetHeader("Accept-Encoding", "gzip");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ("gzip", response.headers.GetHeaderValue("Content-Encoding"));
+    EXPECT_EQ(testFileContent, Gunzip(response.body));
+    request.headers.RemoveHeader("Accept-Encoding");
+
+    // Extend the test file, expecting the old mapping to be released
+    // and the new content to be served from a new mapping.
+    (void)testFile.OpenReadWrite();
+    testFile.SetPosition(testFileContent.length());
+    (void)testFile.Write("The End\r\n", 9);
+    testFile.Close();
+    testFileContent += "The End\r\n";
+    diagnosticMessages.clear();
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(testFileContent, response.body);
+    ASSERT_EQ(2, diagnosticMessages.size());
+    EXPECT_EQ("FileMapping[0]: unmapped '", diagnosticMessages[0].substr(0, 26));
+    EXPECT_EQ("FileMapping[0]: mapped '", diagnosticMessages[1].substr(0, 24));
+}
+
+TEST_F(StaticContentPluginTests, ConditionalRequestsByModificationTime) {
+    // Create test file.
+    SystemAbstractions::File testFile(testAreaPath + "/foo.txt");
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write("Hello!", 6);
+    testFile.Close();
+
+    // Configure plug-in.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+
+    // Revalidate the test file by a date in the future before it has
+    // been served, expecting a header-only response carrying the
+    // headers a full response would have, including the entity tag.
+    Http::Request request;
+    request.target.SetPath({"foo.txt"});
+    request.headers.SetHeader("If-Modified-Since", "Fri, 31 Dec 2049 23:59:59 GMT");
+    auto response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(304, response.statusCode);
+    EXPECT_TRUE(response.body.empty());
+    const auto firstEtag = response.headers.GetHeaderValue("ETag");
+    EXPECT_FALSE(firstEtag.empty());
+    EXPECT_TRUE(response.headers.HasHeader("Last-Modified"));
+
+    // The obsolete date formats should also be understood.
+    request.headers.SetHeader("If-Modified-Since", "Friday, 31-Dec-49 23:59:59 GMT");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(304, response.statusCode);
+    request.headers.SetHeader("If-Modified-Since", "Fri Dec 31 23:59:59 2049");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(304, response.statusCode);
+
+    // Request the test file, expecting its modification time
+    // to be reported.
+    request.headers.RemoveHeader("If-Modified-Since");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ("Hello!", response.body);
+    const auto lastModified = response.headers.GetHeaderValue("Last-Modified");
+    ASSERT_EQ(29, lastModified.length());
+    EXPECT_EQ(" GMT", lastModified.substr(25));
+    const auto etag = response.headers.GetHeaderValue("ETag");
+    EXPECT_EQ(firstEtag, etag);
+
+    // Revalidate by modification time, expecting the file to be unmodified
+    // since the time it reported, but modified since long ago.
+    request.headers.SetHeader("If-Modified-Since", lastModified);
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(304, response.statusCode);
+    EXPECT_TRUE(response.body.empty());
+    EXPECT_EQ(etag, response.headers.GetHeaderValue("ETag"));
+    EXPECT_EQ(lastModified, response.headers.GetHeaderValue("Last-Modified"));
+    request.headers.SetHeader("If-Modified-Since", "Sat, 01 Jan 2000 00:00:00 GMT");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ("Hello!", response.body);
+    request.headers.SetHeader("If-Modified-Since", "not a date");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+
+    // If-None-Match takes precedence over If-Modified-Since.
+    request.headers.SetHeader("If-Modified-Since", lastModified);
+    request.headers.SetHeader("If-None-Match", "\"bogus\"");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    request.headers.RemoveHeader("If-Modified-Since");
+
+    // Lists of entity tags, and "*", should be honored.
+    request.headers.SetHeader("If-None-Match", "\"bogus\", " + etag + ", \"other\"");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(304, response.statusCode);
+    request.headers.SetHeader("If-None-Match", "*");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(304, response.statusCode);
+    request.headers.RemoveHeader("If-None-Match");
+
+    // If-Range may give the modification time instead of an entity tag.
+    request.headers.SetHeader("Range", "bytes=1-2");
+    request.headers.SetHeader("If-Range", lastModified);
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(206, response.statusCode);
+    EXPECT_EQ("el", response.body);
+    request.headers.SetHeader("If-Range", "Sat, 01 Jan 2000 00:00:00 GMT");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ("Hello!", response.body);
+}
+
+TEST_F(StaticContentPluginTests, CacheControlPoliciesApplied) {
+    // Create test files.
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(testAreaPath + "/fonts"));
+    for (const auto name: {"index.html", "app.3f2a9c1d.js", "app.js", "fonts/a.woff"}) {
+        SystemAbstractions::File testFile(testAreaPath + "/" + name);
+        (void)testFile.OpenReadWrite();
+        (void)testFile.Write("Hello!", 6);
+        testFile.Close();
+    }
+
+    // Configure plug-in to revalidate by default, but let fingerprinted
+    // scripts and fonts be cached for a long time.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set(
+        "cacheControl",
+        Json::Object({
+            {"noCache", true},
+            {"overrides", Json::Array({
+                Json::Object({
+                    {"pattern", "*.[0-9a-f][0-9a-f][0-9a-f][0-9a-f]*.js"},
+                    {"maxAge", 31536000},
+                    {"immutable", true},
+                }),
+                Json::Object({
+                    {"pattern", "fonts/*"},
+                    {"maxAge", 86400},
+                }),
+            })},
+        })
+    );
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+
+    // Request each test file, expecting the policy matching its path.
+    const struct {
+        std::vector< std::string > path;
+        std::string cacheControl;
+    } testVectors[] = {
+        {{"index.html"}, "no-cache"},
+        {{"app.3f2a9c1d.js"}, "max-age=31536000, immutable"},
+        {{"app.js"}, "no-cache"},
+        {{"fonts", "a.woff"}, "max-age=86400"},
+    };
+    for (const auto& testVector: testVectors) {
+        Http::Request request;
+        request.target.SetPath(testVector.path);
+        auto response = server.registeredResourceDelegate(request, nullptr, "");
+        EXPECT_EQ(200, response.statusCode);
+        EXPECT_EQ(
+            testVector.cacheControl,
+            response.headers.GetHeaderValue("Cache-Control")
+        ) << StringExtensions::Join(testVector.path, "/");
+
+        // Revalidations should get the same policy.
+        request.headers.SetHeader("If-None-Match", response.headers.GetHeaderValue("ETag"));
+        response = server.registeredResourceDelegate(request, nullptr, "");
+        EXPECT_EQ(304, response.statusCode);
+        EXPECT_EQ(
+            testVector.cacheControl,
+            response.headers.GetHeaderValue("Cache-Control")
+        ) << StringExtensions::Join(testVector.path, "/");
+    }
+
+    // Missing files should not be given a policy.
+    Http::Request request;
+    request.target.SetPath({"missing.js"});
+    const auto response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(404, response.statusCode);
+    EXPECT_FALSE(response.headers.HasHeader("Cache-Control"));
+}
+
+TEST_F(StaticContentPluginTests, ContentTypesResolvedFromTableAndConfiguration) {
+    // Create test files.
+    for (const auto name: {"a.html", "b.SVG", "c.woff2", "d.wasm", "e.md", "f.unknown", "g", "h.custom"}) {
+        SystemAbstractions::File testFile(testAreaPath + "/" + name);
+        (void)testFile.OpenReadWrite();
+        (void)testFile.Write("Hello, World!  Hello, World!", 28);
+        testFile.Close();
+    }
+
+    // Configure plug-in, overriding one built-in type and adding another.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set(
+        "mimeTypes",
+        Json::Object({
+            {".md", "text/x-markdown"},
+            {"CUSTOM", Json::Object({
+                {"type", "application/x-custom"},
+                {"compressible", true},
+            })},
+        })
+    );
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+
+    // Request each test file, expecting the right content type, and
+    // compression only for types worth compressing.
+    const struct {
+        std::string name;
+        std::string contentType;
+        bool compressed;
+    } testVectors[] = {
+        {"a.html", "text/html", true},
+        {"b.SVG", "image/svg+xml", true},
+        {"c.woff2", "font/woff2", false},
+        {"d.wasm", "application/wasm", true},
+        {"e.md", "text/x-markdown", true},
+        {"f.unknown", "application/octet-stream", false},
+        {"g", "application/octet-stream", false},
+        {"h.custom", "application/x-custom", true},
+    };
+    for (const auto& testVector: testVectors) {
+        Http::Request request;
+        request.target.SetPath({testVector.name});
+        request.headers.SetHeader("Accept-Encoding", "gzip");
+        const auto response = server.registeredResourceDelegate(request, nullptr, "");
+        EXPECT_EQ(200, response.statusCode) << testVector.name;
+        EXPECT_EQ(
+            testVector.contentType,
+            response.headers.GetHeaderValue("Content-Type")
+        ) << testVector.name;
+        EXPECT_EQ(
+            testVector.compressed,
+            response.headers.HasHeader("Content-Encoding")
+        ) << testVector.name;
+    }
+}
+
+TEST_F(StaticContentPluginTests, WatchedFilesInvalidatedWhenChanged) {
+    // Create test file.
+    SystemAbstractions::File testFile(testAreaPath + "/foo.txt");
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write("Hello!", 6);
+    testFile.Close();
+
+    // Configure plug-in to watch for changes.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set("watch", true);
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+    const auto awaitBody = [&server](
+        const std::vector< std::string >& path,
+        const std::string& body
+    ){
+        Http::Request request;
+        request.target.SetPath(path);
+        for (size_t i = 0; i < 100; ++i) {
+            const auto response = server.registeredResourceDelegate(request, nullptr, "");
+            if (response.body == body) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    };
+
+    // Request the test file, change it, and expect the new content
+    // to be served shortly afterwards.
+    EXPECT_TRUE(awaitBody({"foo.txt"}, "Hello!"));
+    EXPECT_TRUE(awaitBody({"foo.txt"}, "Hello!"));
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write("World!", 6);
+    testFile.Close();
+    EXPECT_TRUE(awaitBody({"foo.txt"}, "World!"));
+
+    // Files in new subdirectories should be watched as well.
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(testAreaPath + "/sub"));
+    SystemAbstractions::File subFile(testAreaPath + "/sub/bar.txt");
+    (void)subFile.OpenReadWrite();
+    (void)subFile.Write("Hello!", 6);
+    subFile.Close();
+    EXPECT_TRUE(awaitBody({"sub", "bar.txt"}, "Hello!"));
+    (void)subFile.OpenReadWrite();
+    (void)subFile.Write("World!", 6);
+    subFile.Close();
+    EXPECT_TRUE(awaitBody({"sub", "bar.txt"}, "World!"));
+
+    // Deleted files should stop being served.
+    subFile.Destroy();
+    Http::Request request;
+    request.target.SetPath({"sub", "bar.txt"});
+    auto statusCode = 0;
+    for (size_t i = 0; i < 100; ++i) {
+        statusCode = server.registeredResourceDelegate(request, nullptr, "").statusCode;
+        if (statusCode == 404) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(404, statusCode);
+    unloadDelegate();
+}
+
+#ifndef _WIN32
+TEST_F(StaticContentPluginTests, FilesInUnwatchedDirectoriesCheckedOnEveryRequest) {
+    // Create test file in a subdirectory.
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(testAreaPath + "/sub"));
+    SystemAbstractions::File testFile(testAreaPath + "/sub/foo.txt");
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write("Hello!", 6);
+    testFile.Close();
+
+    // Measure how many file descriptors a directory monitor uses,
+    // and then limit the process to just enough of them that the
+    // root of the space can be watched, but not the subdirectory.
+    const auto lowestFreeDescriptor = []{
+        const auto descriptor = dup(0);
+        (void)close(descriptor);
+        return descriptor;
+    };
+    const auto firstFreeDescriptor = lowestFreeDescriptor();
+    size_t descriptorsPerMonitor;
+    {
+        SystemAbstractions::DirectoryMonitor monitor;
+        ASSERT_TRUE(monitor.Start([]{}, testAreaPath));
+        descriptorsPerMonitor = (size_t)(lowestFreeDescriptor() - firstFreeDescriptor);
+        monitor.Stop();
+    }
+    struct rlimit originalLimit;
+    ASSERT_EQ(0, getrlimit(RLIMIT_NOFILE, &originalLimit));
+    auto limit = originalLimit;
+    limit.rlim_cur = (rlim_t)firstFreeDescriptor + descriptorsPerMonitor;
+
+    // Configure plug-in to watch for changes.
+    std::vector< std::string > diagnosticMessages;
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set("watch", true);
+    ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &limit));
+    LoadPlugin(
+        &server,
+        config,
+        [&diagnosticMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            diagnosticMessages.push_back(
+                StringExtensions::sprintf(
+                    "%s[%zu]: %s",
+                    senderName.c_str(),
+                    level,
+                    message.c_str()
+                )
+            );
+        },
+        unloadDelegate
+    );
+    ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &originalLimit));
+    ASSERT_FALSE(unloadDelegate == nullptr);
+    EXPECT_EQ(
+        (std::vector< std::string >{
+            "TreeMonitor[5]: unable to monitor directory '" + testAreaPath + "/sub'",
+        }),
+        diagnosticMessages
+    );
+
+    // Request the test file, change it, and expect the new content
+    // to be served right away, even though the change goes unnoticed
+    // by the plug-in, since the file should be checked every time.
+    Http::Request request;
+    request.target.SetPath({"sub", "foo.txt"});
+    EXPECT_EQ("Hello!", server.registeredResourceDelegate(request, nullptr, "").body);
+    EXPECT_EQ("Hello!", server.registeredResourceDelegate(request, nullptr, "").body);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write("World!", 6);
+    testFile.Close();
+    EXPECT_EQ("World!", server.registeredResourceDelegate(request, nullptr, "").body);
+    unloadDelegate();
+}
+#endif /* POSIX */
+
+TEST_F(StaticContentPluginTests, SpacePreloadedWhenLoaded) {
+    // Create test files, one small enough to be preloaded,
+    // and one too large.
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(testAreaPath + "/sub"));
+    SystemAbstractions::File smallFile(testAreaPath + "/sub/small.txt");
+    (void)smallFile.OpenReadWrite();
+    (void)smallFile.Write("Hello, World!  Hello, World!", 28);
+    smallFile.Close();
+    SystemAbstractions::File largeFile(testAreaPath + "/large.txt");
+    (void)largeFile.OpenReadWrite();
+    const std::string largeFileContent(1000, 'x');
+    (void)largeFile.Write(largeFileContent.data(), largeFileContent.length());
+    largeFile.Close();
+
+    // Configure plug-in to preload files up to 100 bytes in size.
+    std::mutex diagnosticMessagesMutex;
+    std::vector< std::string > diagnosticMessages;
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set("statsPath", "_stats");
+    config.Set(
+        "preload",
+        Json::Object({
+            {"maxFileSize", 100},
+        })
+    );
+    LoadPlugin(
+        &server,
+        config,
+        [&diagnosticMessagesMutex, &diagnosticMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            std::lock_guard< decltype(diagnosticMessagesMutex) > lock(diagnosticMessagesMutex);
+            diagnosticMessages.push_back(
+                StringExtensions::sprintf(
+                    "%s[%zu]: %s",
+                    senderName.c_str(),
+                    level,
+                    message.c_str()
+                )
+            );
+        },
+        unloadDelegate
+    );
+
+    // Wait for preloading to finish.
+    bool finished = false;
+    for (size_t i = 0; (i < 100) && !finished; ++i) {
+        {
+            std::lock_guard< decltype(diagnosticMessagesMutex) > lock(diagnosticMessagesMutex);
+            finished = (
+                !diagnosticMessages.empty()
+                && (diagnosticMessages.back().find("Preloader[0]: preloaded 1 of 2 files (28 bytes)") == 0)
+            );
+        }
+        if (!finished) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    ASSERT_TRUE(finished);
+
+    // Request both files, expecting only the preloaded one to be
+    // cached already, so that only the other one adds an entry
+    // to the cache.
+    Http::Request statsRequest;
+    statsRequest.target.SetPath({"_stats"});
+    auto stats = server.registeredResourceDelegate(statsRequest, nullptr, "");
+    EXPECT_NE(std::string::npos, stats.body.find("\"entries\":1")) << stats.body;
+    Http::Request request;
+    request.target.SetPath({"sub", "small.txt"});
+    auto response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ(
+        Hash::StringToString< Hash::Sha1 >("Hello, World!  Hello, World!"),
+        response.headers.GetHeaderValue("ETag")
+    );
+    stats = server.registeredResourceDelegate(statsRequest, nullptr, "");
+    EXPECT_NE(std::string::npos, stats.body.find("\"entries\":1")) << stats.body;
+    request.target.SetPath({"large.txt"});
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    stats = server.registeredResourceDelegate(statsRequest, nullptr, "");
+    EXPECT_NE(std::string::npos, stats.body.find("\"entries\":2")) << stats.body;
+    unloadDelegate();
+}
+
+TEST_F(StaticContentPluginTests, SpaceServedFromPackedArchive) {
+    // Create test files: one compressible, one not, and one empty.
+    const auto contentPath = testAreaPath + "/content";
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(contentPath));
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(contentPath + "/sub"));
+    std::string scriptContent;
+    for (size_t i = 0; i < 100; ++i) {
+        scriptContent += "console.log('Hello, World!');\n";
+    }
+    SystemAbstractions::File scriptFile(contentPath + "/app.js");
+    (void)scriptFile.OpenReadWrite();
+    (void)scriptFile.Write(scriptContent.data(), scriptContent.length());
+    scriptFile.Close();
+    std::string dataContent;
+    for (size_t i = 0; i < 256; ++i) {
+        dataContent.push_back((char)i);
+    }
+    SystemAbstractions::File dataFile(contentPath + "/sub/data.bin");
+    (void)dataFile.OpenReadWrite();
+    (void)dataFile.Write(dataContent.data(), dataContent.length());
+    dataFile.Close();
+    SystemAbstractions::File emptyFile(contentPath + "/empty.txt");
+    (void)emptyFile.OpenReadWrite();
+    emptyFile.Close();
+
+    // Pack the files using the packing tool, and then delete them,
+    // to make sure they're served from the archive.
+    const auto archivePath = testAreaPath + "/content.pak";
+    ASSERT_EQ(
+        0,
+        system(
+            StringExtensions::sprintf(
+                "\"%s/PackStaticContent\" \"%s\" \"%s\"",
+                SystemAbstractions::File::GetExeParentDirectory().c_str(),
+                contentPath.c_str(),
+                archivePath.c_str()
+            ).c_str()
+        )
+    );
+    ASSERT_TRUE(SystemAbstractions::File::DeleteDirectory(contentPath));
+
+    // Configure plug-in to serve the archive.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("archive", archivePath);
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){},
+        unloadDelegate
+    );
+    ASSERT_FALSE(unloadDelegate == nullptr);
+
+    // Request the compressible file, as is.
+    Http::Request request;
+    request.target.SetPath({"app.js"});
+    auto response = server.registeredResourceDelegate(request, nullptr, "");
+    const auto scriptEntityTag = Hash::StringToString< Hash::Sha1 >(scriptContent);
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ(scriptContent, response.body);
+    EXPECT_EQ("application/javascript", response.headers.GetHeaderValue("Content-Type"));
+    EXPECT_EQ(scriptEntityTag, response.headers.GetHeaderValue("ETag"));
+    EXPECT_EQ("Accept-Encoding", response.headers.GetHeaderValue("Vary"));
+    EXPECT_FALSE(response.headers.HasHeader("Content-Encoding"));
+
+    // Request the compressible file, compressed ahead of time.
+    request.headers.SetHeader("Accept-Encoding", "gzip");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ("gzip", response.headers.GetHeaderValue("Content-Encoding"));
+    EXPECT_LT(response.body.length(), scriptContent.length());
+    EXPECT_EQ(scriptContent, Gunzip(response.body));
+    EXPECT_EQ(scriptEntityTag + "-gzip", response.headers.GetHeaderValue("ETag"));
+
+    // Revalidate the compressible file.
+    request.headers.SetHeader("If-None-Match", scriptEntityTag + "-gzip");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(304, response.statusCode);
+    EXPECT_TRUE(response.body.empty());
+
+    // Request part of the file in the subdirectory.
+    request = Http::Request();
+    request.target.SetPath({"sub", "data.bin"});
+    request.headers.SetHeader("Range", "bytes=16-31");
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(206, response.statusCode);
+    EXPECT_EQ(dataContent.substr(16, 16), response.body);
+    EXPECT_EQ("bytes 16-31/256", response.headers.GetHeaderValue("Content-Range"));
+    EXPECT_EQ("application/octet-stream", response.headers.GetHeaderValue("Content-Type"));
+
+    // Request the empty file.
+    request = Http::Request();
+    request.target.SetPath({"empty.txt"});
+    response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ("", response.body);
+    EXPECT_EQ("0", response.headers.GetHeaderValue("Content-Length"));
+
+    // Request files not in the archive.
+    for (const auto& path: std::vector< std::vector< std::string > >{
+        {"missing.txt"},
+        {"sub"},
+    }) {
+        request.target.SetPath(path);
+        response = server.registeredResourceDelegate(request, nullptr, "");
+        EXPECT_EQ(404, response.statusCode);
+    }
+    unloadDelegate();
+}
+
+TEST_F(StaticContentPluginTests, MissingPathsTurnedAwayUntilTreeChanges) {
+    // Create test file.
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(testAreaPath + "/sub"));
+    SystemAbstractions::File testFile(testAreaPath + "/sub/foo.txt");
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write("Hello!", 6);
+    testFile.Close();
+
+    // Configure plug-in to watch for changes, remembering missing
+    // paths and filtering them against the files in the tree.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set("watch", true);
+    config.Set(
+        "notFound",
+        Json::Object({
+            {"cacheSize", 2},
+            {"filter", true},
+        })
+    );
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){},
+        unloadDelegate
+    );
+    ASSERT_FALSE(unloadDelegate == nullptr);
+    const auto request = [&server](const std::vector< std::string >& path){
+        Http::Request request;
+        request.target.SetPath(path);
+        return server.registeredResourceDelegate(request, nullptr, "");
+    };
+
+    // Missing paths are given the same response, which doesn't
+    // reveal where files are kept.
+    for (const auto& path: std::vector< std::vector< std::string > >{
+        {"bar.txt"},
+        {".env"},
+        {"wp-admin", "index.php"},
+        {"bar.txt"},
+        {"sub"},
+    }) {
+        const auto response = request(path);
+        EXPECT_EQ(404, response.statusCode);
+        EXPECT_EQ("Not found.", response.body);
+        EXPECT_EQ("10", response.headers.GetHeaderValue("Content-Length"));
+    }
+
+    // Paths which aren't in canonical form are never ruled out
+    // by the filter.
+    EXPECT_EQ("Hello!", request({"sub", "foo.txt"}).body);
+    EXPECT_EQ("Hello!", request({"sub", "", "foo.txt"}).body);
+
+    // Paths found missing are served once they appear.
+    SystemAbstractions::File newFile(testAreaPath + "/bar.txt");
+    (void)newFile.OpenReadWrite();
+    (void)newFile.Write("World!", 6);
+    newFile.Close();
+    auto found = false;
+    for (size_t i = 0; (i < 100) && !found; ++i) {
+        found = (request({"bar.txt"}).body == "World!");
+        if (!found) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    EXPECT_TRUE(found);
+    unloadDelegate();
+}
+
+TEST_F(StaticContentPluginTests, ScanResistantCachePolicyKeepsHotFiles) {
+    // Create one "hot" test file and several "cold" ones,
+    // each of which fills about a quarter of the cache.
+    const std::string testFileContent(1000, 'x');
+    std::vector< std::string > testFileNames{"hot.txt"};
+    for (size_t i = 0; i < 10; ++i) {
+        testFileNames.push_back(StringExtensions::sprintf("cold%zu.txt", i));
+    }
+    for (const auto& testFileName: testFileNames) {
+        SystemAbstractions::File testFile(testAreaPath + "/" + testFileName);
+        (void)testFile.OpenReadWrite();
+        (void)testFile.Write(testFileContent.data(), testFileContent.length());
+        testFile.Close();
+    }
+
+    // With each cache policy, request the hot file a few times, then
+    // "crawl" the cold files, and finally request the hot file again.
+    // Only the scan-resistant policy should still have it cached.
+    for (const auto& policy: {"lru", "w-tinylfu"}) {
+        MockServer server;
+        std::function< void() > unloadDelegate;
+        Json::Value config(Json::Value::Type::Object);
+        config.Set("space", "/");
+        config.Set("root", testAreaPath);
+        config.Set("cacheSize", 5000);
+        config.Set("cachePolicy", policy);
+        config.Set("statsPath", "_stats");
+        LoadPlugin(
+            &server,
+            config,
+            [](
+                std::string senderName,
+                size_t level,
+                std::string message
+            ){
+                printf(
+                    "[%s:%zu] %s\n",
+                    senderName.c_str(),
+                    level,
+                    message.c_str()
+                );
+            },
+            unloadDelegate
+        );
+        const auto get = [&server](const std::string& path){
+            Http::Request request;
+            request.target.SetPath({path});
+            return server.registeredResourceDelegate(request, nullptr, "");
+        };
+        for (size_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(testFileContent, get("hot.txt").body);
+        }
+        for (size_t i = 1; i < testFileNames.size(); ++i) {
+            EXPECT_EQ(testFileContent, get(testFileNames[i]).body);
+        }
+        EXPECT_EQ(testFileContent, get("hot.txt").body);
+        const auto response = get("_stats");
+        EXPECT_EQ(200, response.statusCode);
+        EXPECT_EQ("application/json", response.headers.GetHeaderValue("Content-Type"));
+        EXPECT_EQ("no-store", response.headers.GetHeaderValue("Cache-Control"));
+        EXPECT_NE(std::string::npos, response.body.find("\"capacity\":5000")) << policy;
+        if (std::string(policy) == "lru") {
+            EXPECT_NE(std::string::npos, response.body.find("\"hits\":2")) << response.body;
+            EXPECT_NE(std::string::npos, response.body.find("\"misses\":12")) << response.body;
+            EXPECT_NE(std::string::npos, response.body.find("\"rejections\":0")) << response.body;
+            EXPECT_EQ(std::string::npos, response.body.find("\"evictions\":0")) << response.body;
+        } else {
+            EXPECT_NE(std::string::npos, response.body.find("\"hits\":3")) << response.body;
+            EXPECT_NE(std::string::npos, response.body.find("\"misses\":11")) << response.body;
+            EXPECT_EQ(std::string::npos, response.body.find("\"rejections\":0")) << response.body;
+        }
+        unloadDelegate();
+    }
+}
+
+TEST_F(StaticContentPluginTests, ResponseHeadersReusedUntilFileChanges) {
+    // Create test file.
+    std::string testFileContent;
+    for (size_t i = 0; i < 50; ++i) {
+        testFileContent += "Hello, World! ";
+    }
+    SystemAbstractions::File testFile(testAreaPath + "/foo.txt");
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write(testFileContent.data(), testFileContent.length());
+    testFile.Close();
+
+    // Configure plug-in.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set("cacheControl", Json::Object({{"maxAge", 60}}));
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+
+    // Request the test file a few times, both as is and compressed,
+    // expecting exactly the same header block each time.
+    for (const auto& acceptEncoding: {"", "gzip"}) {
+        Http::Request request;
+        request.target.SetPath({"foo.txt"});
+        if (*acceptEncoding != '\0') {
+            request.headers.SetHeader("Accept-Encoding", acceptEncoding);
+        }
+        const auto firstResponse = server.registeredResourceDelegate(request, nullptr, "");
+        EXPECT_EQ(200, firstResponse.statusCode);
+        EXPECT_EQ(acceptEncoding, firstResponse.headers.GetHeaderValue("Content-Encoding"));
+        EXPECT_EQ(
+            StringExtensions::sprintf("%zu", firstResponse.body.length()),
+            firstResponse.headers.GetHeaderValue("Content-Length")
+        );
+        for (size_t i = 0; i < 2; ++i) {
+            const auto response = server.registeredResourceDelegate(request, nullptr, "");
+            EXPECT_EQ(200, response.statusCode);
+            EXPECT_EQ("OK", response.reasonPhrase);
+            EXPECT_EQ(
+                firstResponse.headers.GenerateRawHeaders(),
+                response.headers.GenerateRawHeaders()
+            );
+            EXPECT_EQ(firstResponse.body, response.body);
+        }
+    }
+
+    // Change the test file, and expect the header block
+    // to describe the new version.
+    testFile.Destroy();
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write("Hello!", 6);
+    testFile.Close();
+    Http::Request request;
+    request.target.SetPath({"foo.txt"});
+    const auto response = server.registeredResourceDelegate(request, nullptr, "");
+    EXPECT_EQ("Hello!", response.body);
+    EXPECT_EQ("6", response.headers.GetHeaderValue("Content-Length"));
+    EXPECT_EQ(
+        Hash::StringToString< Hash::Sha1 >("Hello!"),
+        response.headers.GetHeaderValue("ETag")
+    );
+    unloadDelegate();
+}
+
+TEST_F(StaticContentPluginTests, IdenticalFilesInDifferentSpacesHeldOnce) {
+    // Create the same test file in three spaces.
+    std::string testFileContent;
+    for (size_t i = 0; i < 50; ++i) {
+        testFileContent += "Hello, World! ";
+    }
+    const std::vector< std::string > spaceNames{"foo", "bar", "baz"};
+    for (const auto& spaceName: spaceNames) {
+        ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(testAreaPath + "/" + spaceName));
+        SystemAbstractions::File testFile(testAreaPath + "/" + spaceName + "/hello.txt");
+        (void)testFile.OpenReadWrite();
+        (void)testFile.Write(testFileContent.data(), testFileContent.length());
+        testFile.Close();
+    }
+
+    // Configure plug-in, opting the last space out of deduplication.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set(
+        "spaces",
+        Json::Array(
+            {
+                Json::Object({
+                    {"space", "/foo"},
+                    {"root", testAreaPath + "/foo"},
+                    {"statsPath", "_stats"},
+                }),
+                Json::Object({
+                    {"space", "/bar"},
+                    {"root", testAreaPath + "/bar"},
+                }),
+                Json::Object({
+                    {"space", "/baz"},
+                    {"root", testAreaPath + "/baz"},
+                    {"statsPath", "_stats"},
+                    {"deduplicate", false},
+                }),
+            }
+        )
+    );
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+    const auto get = [&server](
+        const std::string& spaceName,
+        const std::string& path,
+        const std::string& acceptEncoding
+    ){
+        Http::Request request;
+        if (!acceptEncoding.empty()) {
+            request.headers.SetHeader("Accept-Encoding", acceptEncoding);
+        }
+        request.target.SetPath({path});
+        return server.registeredResourceDelegates[spaceName](request, nullptr, "");
+    };
+
+    // Request the file from every space, both as is and compressed.
+    for (const auto& spaceName: spaceNames) {
+        EXPECT_EQ(testFileContent, get(spaceName, "hello.txt", "").body);
+        const auto response = get(spaceName, "hello.txt", "gzip");
+        EXPECT_EQ("gzip", response.headers.GetHeaderValue("Content-Encoding"));
+    }
+
+    // The second space should have found both the file and its
+    // compressed variant already in memory, and the third space
+    // shouldn't have been considered at all.
+    auto response = get("foo", "_stats", "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_NE(std::string::npos, response.body.find("\"contents\":2")) << response.body;
+    EXPECT_NE(std::string::npos, response.body.find("\"duplicates\":2")) << response.body;
+    response = get("baz", "_stats", "");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ(std::string::npos, response.body.find("deduplication")) << response.body;
+    unloadDelegate();
+}
+
+TEST_F(StaticContentPluginTests, HeadRequestAnsweredWithoutBody) {
+    // Create test file.
+    std::string testFileContent;
+    for (size_t i = 0; i < 50; ++i) {
+        testFileContent += "Hello, World! ";
+    }
+    SystemAbstractions::File testFile(testAreaPath + "/foo.txt");
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write(testFileContent.data(), testFileContent.length());
+    testFile.Close();
+
+    // Configure plug-in.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set("statsPath", "_stats");
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+    const auto request = [&server](const std::string& method){
+        Http::Request request;
+        request.method = method;
+        request.headers.SetHeader("Accept-Encoding", "gzip");
+        request.target.SetPath({"foo.txt"});
+        return server.registeredResourceDelegate(request, nullptr, "");
+    };
+
+    // Before the file is cached, a HEAD request describes the file
+    // as is, since it isn't compressed just to measure the compressed
+    // variant, but with the same entity tag a GET request would get.
+    auto response = request("HEAD");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ("", response.body);
+    EXPECT_EQ(
+        StringExtensions::sprintf("%zu", testFileContent.length()),
+        response.headers.GetHeaderValue("Content-Length")
+    );
+    EXPECT_EQ("text/plain", response.headers.GetHeaderValue("Content-Type"));
+    EXPECT_EQ(
+        Hash::StringToString< Hash::Sha1 >(testFileContent),
+        response.headers.GetHeaderValue("ETag")
+    );
+    EXPECT_FALSE(response.headers.HasHeader("Content-Encoding"));
+
+    // Once the file has been served, a HEAD request is answered
+    // with the same headers as a GET request.
+    const auto getResponse = request("GET");
+    EXPECT_EQ(200, getResponse.statusCode);
+    EXPECT_EQ("gzip", getResponse.headers.GetHeaderValue("Content-Encoding"));
+    response = request("HEAD");
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ("", response.body);
+    EXPECT_EQ(
+        getResponse.headers.GenerateRawHeaders(),
+        response.headers.GenerateRawHeaders()
+    );
+    unloadDelegate();
+}
+
+TEST_F(StaticContentPluginTests, IndexedSpaceResolvesFilesAndRejectsTraversal) {
+    // Create a test file in the space, and another outside of it.
+    const auto spaceTestAreaPath = testAreaPath + "/space";
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(spaceTestAreaPath));
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(spaceTestAreaPath + "/sub"));
+    SystemAbstractions::File testFile(spaceTestAreaPath + "/sub/foo.txt");
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write("Hello!", 6);
+    testFile.Close();
+    SystemAbstractions::File secretFile(testAreaPath + "/secret.txt");
+    (void)secretFile.OpenReadWrite();
+    (void)secretFile.Write("Secret!", 7);
+    secretFile.Close();
+
+    // With and without an index, files in the space should be
+    // served, and files outside of it should not.
+    for (const auto pathIndex: {false, true}) {
+        MockServer server;
+        std::function< void() > unloadDelegate;
+        Json::Value config(Json::Value::Type::Object);
+        config.Set("space", "/");
+        config.Set("root", spaceTestAreaPath);
+        config.Set("watch", true);
+        config.Set("pathIndex", pathIndex);
+        LoadPlugin(
+            &server,
+            config,
+            [](
+                std::string senderName,
+                size_t level,
+                std::string message
+            ){
+                printf(
+                    "[%s:%zu] %s\n",
+                    senderName.c_str(),
+                    level,
+                    message.c_str()
+                );
+            },
+            unloadDelegate
+        );
+        const auto get = [&server](const std::vector< std::string >& path){
+            Http::Request request;
+            request.target.SetPath(path);
+            return server.registeredResourceDelegate(request, nullptr, "");
+        };
+        auto response = get({"sub", "foo.txt"});
+        EXPECT_EQ(200, response.statusCode) << pathIndex;
+        EXPECT_EQ("Hello!", response.body);
+        EXPECT_EQ(404, get({"sub", "bar.txt"}).statusCode) << pathIndex;
+        EXPECT_EQ(404, get({"sub"}).statusCode) << pathIndex;
+        EXPECT_EQ(404, get({"..", "secret.txt"}).statusCode) << pathIndex;
+        EXPECT_EQ(404, get({"sub", "..", "..", "secret.txt"}).statusCode) << pathIndex;
+        EXPECT_EQ(404, get({"sub", ".", "foo.txt"}).statusCode) << pathIndex;
+        EXPECT_EQ(404, get({"sub", std::string("foo.txt\0", 8)}).statusCode) << pathIndex;
+
+        // Separators encoded within a single path segment
+        // shouldn't get around the check.
+        Http::Request request;
+        ASSERT_TRUE(request.target.ParseFromString("sub%2F..%2F..%2Fsecret.txt"));
+        ASSERT_EQ(
+            (std::vector< std::string >{"sub/../../secret.txt"}),
+            request.target.GetPath()
+        );
+        EXPECT_EQ(404, server.registeredResourceDelegate(request, nullptr, "").statusCode) << pathIndex;
+        ASSERT_TRUE(request.target.ParseFromString("..%5Csecret.txt"));
+        EXPECT_EQ(404, server.registeredResourceDelegate(request, nullptr, "").statusCode) << pathIndex;
+        unloadDelegate();
+    }
+}
+
+TEST_F(StaticContentPluginTests, FilesCompressedInBackgroundThenRecompressed) {
+    // Create a test file of text which compresses better
+    // at higher compression levels.
+    std::string testFileContent;
+    uint32_t seed = 1;
+    const char* const words[] = {"alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta"};
+    while (testFileContent.length() < 65536) {
+        seed = seed * 1103515245 + 12345;
+        testFileContent += words[(seed >> 16) % 8];
+        testFileContent += (((seed >> 8) % 7 == 0) ? "\n" : " ");
+    }
+    SystemAbstractions::File testFile(testAreaPath + "/foo.txt");
+    (void)testFile.OpenReadWrite();
+    (void)testFile.Write(testFileContent.data(), testFileContent.length());
+    testFile.Close();
+
+    // Configure plug-in.
+    MockServer server;
+    std::function< void() > unloadDelegate;
+    Json::Value config(Json::Value::Type::Object);
+    config.Set("space", "/");
+    config.Set("root", testAreaPath);
+    config.Set(
+        "compression",
+        Json::Object({
+            {"codings", Json::Array({"gzip"})},
+            {"background", Json::Object({{"maxCpuShare", 1}})},
+        })
+    );
+    LoadPlugin(
+        &server,
+        config,
+        [](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            printf(
+                "[%s:%zu] %s\n",
+                senderName.c_str(),
+                level,
+                message.c_str()
+            );
+        },
+        unloadDelegate
+    );
+    const auto get = [&server]{
+        Http::Request request;
+        request.headers.SetHeader("Accept-Encoding", "gzip");
+        request.target.SetPath({"foo.txt"});
+        return server.registeredResourceDelegate(request, nullptr, "");
+    };
+
+    // The first request should be answered with the file as is,
+    // while it's compressed in the background.
+    auto response = get();
+    EXPECT_EQ(200, response.statusCode);
+    EXPECT_EQ(testFileContent, response.body);
+    EXPECT_FALSE(response.headers.HasHeader("Content-Encoding"));
+    EXPECT_EQ("Accept-Encoding", response.headers.GetHeaderValue("Vary"));
+
+    // The file should soon be served compressed, first quickly,
+    // and then as tightly as possible.
+    const auto fastLength = Gzip(testFileContent, 1).length();
+    const auto bestLength = Gzip(testFileContent, 9).length();
+    ASSERT_LT(bestLength, fastLength);
+    std::set< size_t > compressedLengths;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        response = get();
+        if (response.headers.GetHeaderValue("Content-Encoding") == "gzip") {
+            EXPECT_EQ(testFileContent, Gunzip(response.body));
+            EXPECT_EQ(
+                StringExtensions::sprintf("%zu", response.body.length()),
+                response.headers.GetHeaderValue("Content-Length")
+            );
+            EXPECT_EQ("W/", response.headers.GetHeaderValue("ETag").substr(0, 2));
+            (void)compressedLengths.insert(response.body.length());
+            if (response.body.length() == bestLength) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(bestLength, response.body.length());
+    compressedLengths.erase(fastLength);
+    compressedLengths.erase(bestLength);
+    EXPECT_TRUE(compressedLengths.empty());
+    unloadDelegate();
+}
+
+TEST_F(StaticContentPluginTests, DirectoriesServedThroughIndexFiles) {
+    // Create a space with index files at its root and in a subdirectory,
+    // and a subdirectory without one.
+    const auto spaceTestAreaPath = testAreaPath + "/space";
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(spaceTestAreaPath));
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(spaceTestAreaPath + "/docs"));
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(spaceTestAreaPath + "/empty"));
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(spaceTestAreaPath + "/old docs%2Fv1"));
+    const std::pair< const char*, const char* > files[] = {
+        {"/index.html", "Home"},
+        {"/docs/index.html", "Docs"},
+        {"/old docs%2Fv1/index.html", "Old Docs"},
+        {"/empty/foo.txt", "Foo"},
+    };
+    for (const auto& file: files) {
+        SystemAbstractions::File testFile(spaceTestAreaPath + file.first);
+        (void)testFile.OpenReadWrite();
+        (void)testFile.Write(file.second, strlen(file.second));
+        testFile.Close();
+    }
+
+    // With every way of finding files, directories with index files
+    // should be served through them, with requests for them lacking
+    // a trailing slash redirected, and other directories not found.
+    for (const auto& watch: {false, true}) {
+        for (const auto& index: {false, true}) {
+            MockServer server;
+            std::function< void() > unloadDelegate;
+            Json::Value config(Json::Value::Type::Object);
+            config.Set("space", "/site");
+            config.Set("root", spaceTestAreaPath);
+            config.Set("watch", watch);
+            config.Set("pathIndex", index);
+            config.Set("notFound", Json::Object({{"filter", true}}));
+            LoadPlugin(
+                &server,
+                config,
+                [](
+                    std::string senderName,
+                    size_t level,
+                    std::string message
+                ){
+                    printf(
+                        "[%s:%zu] %s\n",
+                        senderName.c_str(),
+                        level,
+                        message.c_str()
+                    );
+                },
+                unloadDelegate
+            );
+            const auto get = [&server](const std::vector< std::string >& path){
+                Http::Request request;
+                request.target.SetPath(path);
+                return server.registeredResourceDelegate(request, nullptr, "");
+            };
+            for (size_t i = 0; i < 2; ++i) {
+                auto response = get({});
+                EXPECT_EQ(200, response.statusCode);
+                EXPECT_EQ("Home", response.body);
+                EXPECT_EQ("text/html", response.headers.GetHeaderValue("Content-Type"));
+                response = get({"docs", ""});
+                EXPECT_EQ(200, response.statusCode);
+                EXPECT_EQ("Docs", response.body);
+                response = get({"docs"});
+                EXPECT_EQ(301, response.statusCode);
+                EXPECT_EQ("/site/docs/", response.headers.GetHeaderValue("Location"));
+                response = get({"old docs%2Fv1"});
+                EXPECT_EQ(301, response.statusCode);
+                EXPECT_EQ(
+                    "/site/old%20docs%252Fv1/",
+                    response.headers.GetHeaderValue("Location")
+                );
+                EXPECT_EQ(404, get({"empty"}).statusCode);
+                EXPECT_EQ(404, get({"empty", ""}).statusCode);
+                EXPECT_EQ(200, get({"empty", "foo.txt"}).statusCode);
+            }
+            unloadDelegate();
+        }
+    }
+}
@@ -0,0 +1,139 @@
+/**
+ * @file main.cpp
+ *
+ * This module holds the main() function, which is the entrypoint
+ * to the program which packs a directory tree of static content
+ * into an asset archive for the Static Content plug-in to serve.
+ *
+ * © 2018-2019 by Richard Walters
+ */
+
+#include "AssetArchive.hpp"
+#include "AssetPacker.hpp"
+#include "Compression.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <SystemAbstractions/DiagnosticsStreamReporter.hpp>
+
+namespace {
+
+    /**
+     * This contains variables set through the operating system environment
+     * or the command-line arguments.
+     */
+    struct Environment {
+        /**
+         * This is the path to the directory tree to pack.
+         */
+        std::string root;
+
+        /**
+         * This is the path to the archive to make.
+         */
+        std::string archivePath;
+    };
+
+    /**
+     * This function prints to the standard error stream information
+     * about how to use this program.
+     */
+    void PrintUsageInformation() {
+        fprintf(
+            stderr,
+            (
+                "Usage: PackStaticContent ROOT ARCHIVE\n"
+                "\n"
+                "Pack the files of a directory tree into an archive for\n"
+                "the Static Content plug-in to serve.\n"
+                "\n"
+                "  ROOT     Path to the directory containing the files to pack\n"
+                "  ARCHIVE  Path of the archive to make (or replace)\n"
+            )
+        );
+    }
+
+    /**
+     * This function updates the program environment to incorporate
+     * any applicable command-line arguments.
+     *
+     * @param[in] argc
+     *     This is the number of command-line arguments given to the program.
+     *
+     * @param[in] argv
+     *     This is the array of command-line arguments given to the program.
+     *
+     * @param[in,out] environment
+     *     This is the environment to update.
+     *
+     * @return
+     *     An indication of whether or not the function succeeded is returned.
+     */
+    bool ProcessCommandLineArguments(
+        int argc,
+        char* argv[],
+        Environment& environment
+    ) {
+        if (argc != 3) {
+            fprintf(stderr, "error: expected exactly two arguments\n");
+            return false;
+        }
+        environment.root = argv[1];
+        while (
+            (environment.root.length() > 1)
+            && (environment.root.back() == '/')
+        ) {
+            environment.root.pop_back();
+        }
+        environment.archivePath = argv[2];
+        return true;
+    }
+
+}
+
+/**
+ * This function is the entrypoint of the program.
+ * It packs the files of the given directory tree into an archive.
+ *
+ * @param[in] argc
+ *     This is the number of command-line arguments given to the program.
+ *
+ * @param[in] argv
+ *     This is the array of command-line arguments given to the program.
+ */
+int main(int argc, char* argv[]) {
+    Environment environment;
+    if (!ProcessCommandLineArguments(argc, argv, environment)) {
+        PrintUsageInformation();
+        return EXIT_FAILURE;
+    }
+
+    // Since files are compressed only once, ahead of time, use the
+    // best compression available, regardless of how long it takes.
+    CompressionSettings compression;
+    for (const auto coding: {"br", "gzip"}) {
+        if (IsContentCodingSupported(coding)) {
+            compression.codings.push_back(coding);
+        }
+    }
+    compression.gzipLevel = 9;
+    compression.brotliQuality = 11;
+    const auto diagnosticsPublisher = SystemAbstractions::DiagnosticsStreamReporter(stdout, stderr);
+    if (
+        !PackAssets(
+            environment.root,
+            environment.archivePath,
+            compression,
+            diagnosticsPublisher
+        )
+    ) {
+        return EXIT_FAILURE;
+    }
+
+    // Make sure the plug-in will be able to open what we made.
+    if (AssetArchive::Open(environment.archivePath, diagnosticsPublisher) == nullptr) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}